@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+
+static void BM_ArrayConstruct(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Array<int> a(n);
+        benchmark::DoNotOptimize(&a);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayConstruct)->RangeMultiplier(8)->Range(1<<4, 1<<20);
+
+static void BM_ArrayCopy(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> a(n);
+    for (auto _ : state) {
+        Array<int> c(a);
+        benchmark::DoNotOptimize(&c);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(int));
+}
+BENCHMARK(BM_ArrayCopy)->RangeMultiplier(8)->Range(1<<4, 1<<20);
+
+// 通过operator[]顺序访问，每次访问都检查下标
+static void BM_ArrayIndexScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i] = i;
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned i=0; i!=n; i++)
+            sum += a[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayIndexScan)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+// 通过Pointer遍历，每次解引用都经过ArrayData
+static void BM_PointerScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i] = i;
+    for (auto _ : state) {
+        long sum = 0;
+        Pointer<int> end(a, n);
+        for (Pointer<int> p(a, 0); p!=end; ++p)
+            sum += *p;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_PointerScan)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+// 一次resize到n，需要复制原来的元素
+static void BM_ArrayResize(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Array<int> a(n/2);
+        a.resize(n);
+        benchmark::DoNotOptimize(&a);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayResize)->RangeMultiplier(8)->Range(1<<4, 1<<20);
+
+// 逐个添加元素，依靠reserve按2倍增长
+static void BM_ArrayReserveGrow(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Array<int> a;
+        for (unsigned i=0; i!=n; i++) {
+            a.reserve(i);
+            a[i] = i;
+        }
+        benchmark::DoNotOptimize(&a);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayReserveGrow)->RangeMultiplier(8)->Range(1<<4, 1<<20);
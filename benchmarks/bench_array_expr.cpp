@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+#include "array_expr.h"
+
+// 每个运算都返回一个新的Array，作为对比
+static Array<double> add(const Array<double> &a, const Array<double> &b)
+{
+    Array<double> r(a.size());
+    for (unsigned i=0; i!=a.size(); i++)
+        r[i] = a[i] + b[i];
+    return r;
+}
+
+static Array<double> mul(const Array<double> &a, double k)
+{
+    Array<double> r(a.size());
+    for (unsigned i=0; i!=a.size(); i++)
+        r[i] = a[i] * k;
+    return r;
+}
+
+static void fill(Array<double> &a)
+{
+    for (unsigned i=0; i!=a.size(); i++)
+        a[i] = i;
+}
+
+// c = a + b*k，产生两个临时数组
+static void BM_ArrayTemporaries(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<double> a(n), b(n), c(n);
+    fill(a);
+    fill(b);
+    for (auto _ : state) {
+        c = add(a, mul(b, 1.5));
+        benchmark::DoNotOptimize(&c[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayTemporaries)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+// 手写的循环，经过operator[]的下标检查
+static void BM_ArrayHandLoop(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<double> a(n), b(n), c(n);
+    fill(a);
+    fill(b);
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++)
+            c[i] = a[i] + b[i] * 1.5;
+        benchmark::DoNotOptimize(&c[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayHandLoop)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+static void BM_ArrayExprFused(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<double> a(n), b(n), c(n);
+    fill(a);
+    fill(b);
+    for (auto _ : state) {
+        c = a + b * 1.5;
+        benchmark::DoNotOptimize(&c[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayExprFused)->RangeMultiplier(8)->Range(1<<10, 1<<22);
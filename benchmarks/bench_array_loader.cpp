@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "array_loader.h"
+
+// 读入一个64MB的文件并对每个元素做一些计算。文件在页缓存中，
+// 所以测量的是读取(复制)与计算的重叠，而不是磁盘本身。
+static std::string path;
+
+static void remove_data_file()
+{
+    std::remove(path.c_str());
+}
+
+static const char *data_file()
+{
+    if (path.empty()) {
+        char tmpl[] = "/tmp/bench_loaderXXXXXX";
+        int fd = mkstemp(tmpl);
+        std::vector<float> v(1 << 24);
+        for (unsigned i=0; i!=v.size(); i++)
+            v[i] = float(i % 1000);
+        if (write(fd, &v[0], v.size()*sizeof(float)) < 0)
+            std::perror("write");
+        close(fd);
+        path = tmpl;
+        std::atexit(remove_data_file);
+    }
+    return path.c_str();
+}
+
+static double process(const Array<float> &a, unsigned begin, unsigned end)
+{
+    const float *p = &a[0];
+    double s = 0;
+    for (unsigned i=begin; i!=end; i++)
+        s += std::sqrt(p[i]);
+    return s;
+}
+
+// 先读完整个文件，再计算
+static void BM_BlockingLoadThenProcess(benchmark::State &state)
+{
+    const char *path = data_file();
+    for (auto _ : state) {
+        Array<float> a;
+        {
+            int fd = open(path, O_RDONLY);
+            struct stat st;
+            fstat(fd, &st);
+            a.resize(unsigned(st.st_size / sizeof(float)));
+            char *buf = reinterpret_cast<char *>(&a[0]);
+            std::size_t got = 0;
+            while (got<std::size_t(st.st_size)) {
+                ssize_t r = read(fd, buf+got, st.st_size-got);
+                if (r<=0) break;
+                got += r;
+            }
+            close(fd);
+        }
+        benchmark::DoNotOptimize(process(a, 0, a.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * (std::size_t(1) << 26));
+}
+BENCHMARK(BM_BlockingLoadThenProcess)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// 每读完一块就计算这一块；参数为后端与每块的元素数
+static void BM_PipelinedLoad(benchmark::State &state)
+{
+    const char *path = data_file();
+    ArrayLoader loader(ArrayLoader::Backend(state.range(0)));
+    const unsigned chunk = state.range(1);
+    state.SetLabel(loader.backend()==ArrayLoader::URING ? "io_uring" : "threads");
+    for (auto _ : state) {
+        Array<float> a;
+        double s = 0;
+        loader.load(path, a, chunk, [&](unsigned begin, unsigned end) {
+            s += process(a, begin, end);
+        });
+        benchmark::DoNotOptimize(s);
+    }
+    state.SetBytesProcessed(state.iterations() * (std::size_t(1) << 26));
+}
+BENCHMARK(BM_PipelinedLoad)
+    ->ArgsProduct({{ArrayLoader::URING, ArrayLoader::THREADS}, {1 << 16, 1 << 18}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
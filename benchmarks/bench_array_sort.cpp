@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include "array.h"
+#include "array_sort.h"
+
+// 每次迭代前重新填入随机数(不计时)。参数为元素个数与线程数
+static void fill(Array<unsigned> &a)
+{
+    std::mt19937 gen(a.size());
+    for (unsigned i=0; i!=a.size(); i++)
+        a[i] = gen();
+}
+
+static void BM_StdSort(benchmark::State &state)
+{
+    Array<unsigned> a(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        fill(a);
+        state.ResumeTiming();
+        std::sort(&a[0], &a[0] + a.size());
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_StdSort)->Args({1<<20, 1})->Args({1<<24, 1})->Unit(benchmark::kMillisecond);
+
+static void BM_RadixSort(benchmark::State &state)
+{
+    Array<unsigned> a(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        fill(a);
+        state.ResumeTiming();
+        radix_sort(a, state.range(1));
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_RadixSort)->ArgsProduct({{1<<20, 1<<24}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_MergeSort(benchmark::State &state)
+{
+    Array<unsigned> a(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        fill(a);
+        state.ResumeTiming();
+        merge_sort(a, [](unsigned x, unsigned y) { return x<y; }, state.range(1));
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+BENCHMARK(BM_MergeSort)->ArgsProduct({{1<<20, 1<<24}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
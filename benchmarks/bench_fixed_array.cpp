@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+#include "fixed_array.h"
+
+// 热路径中的小临时数组：Array<T>每次都要分配，Array<T, N>在栈上
+static void BM_DynamicSmallArray(benchmark::State &state)
+{
+    unsigned x = 1;
+    for (auto _ : state) {
+        Array<unsigned> a(4);
+        for (unsigned i=0; i!=4; i++)
+            a[i] = x*i;
+        x += a[3] - a[2];
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_DynamicSmallArray);
+
+static void BM_FixedSmallArray(benchmark::State &state)
+{
+    unsigned x = 1;
+    for (auto _ : state) {
+        Array<unsigned, 4> a;
+        for (unsigned i=0; i!=4; i++)
+            a[i] = x*i;
+        x += a[3] - a[2];
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_FixedSmallArray);
+
+// 查表数每个字的1的个数：运行时建表的Array<T>与编译时建好的Array<T, N>
+struct Popcount {
+    constexpr unsigned char operator()(unsigned i) const {
+        return i ? (i&1) + (*this)(i>>1) : 0;
+    }
+};
+static constexpr Array<unsigned char, 256> fixed_table = generate<unsigned char, 256>(Popcount());
+
+static void BM_DynamicTableLookup(benchmark::State &state)
+{
+    Array<unsigned char> table(256);
+    for (unsigned i=0; i!=256; i++)
+        table[i] = Popcount()(i);
+    unsigned x = 12345;
+    for (auto _ : state) {
+        unsigned bits = 0;
+        for (unsigned k=0; k!=1024; k++, x = x*1103515245 + 12345)
+            bits += table[x&255] + table[(x>>8)&255] + table[(x>>16)&255] + table[x>>24];
+        benchmark::DoNotOptimize(bits);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_DynamicTableLookup);
+
+static void BM_FixedTableLookup(benchmark::State &state)
+{
+    unsigned x = 12345;
+    for (auto _ : state) {
+        unsigned bits = 0;
+        for (unsigned k=0; k!=1024; k++, x = x*1103515245 + 12345)
+            bits += fixed_table[x&255] + fixed_table[(x>>8)&255]
+                  + fixed_table[(x>>16)&255] + fixed_table[x>>24];
+        benchmark::DoNotOptimize(bits);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_FixedTableLookup);
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "surrogate.h"
+#include "handle.h"
+
+// 复制代价较大的对象
+class Big:public Super{
+public:
+    Big():payload(4096, 'x') {}
+    virtual Super* clone()const {INSTRUMENT_COUNT(SUPER_CLONE, 1); return new Big(*this);}
+private:
+    std::vector<char> payload;
+};
+
+// 复制vector<Surrogate>：每个元素都克隆一个Big
+static void BM_SurrogateCopyBig(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::vector<Surrogate> v(n, Surrogate(Big()));
+    for (auto _ : state) {
+        std::vector<Surrogate> c(v);
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateCopyBig)->RangeMultiplier(8)->Range(1<<6, 1<<14);
+
+// 复制vector<Handle>：每个元素只增加引用计数
+static void BM_HandleCopyBig(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::vector<Handle> v;
+    for (unsigned i=0; i!=n; i++)
+        v.push_back(Big());
+    for (auto _ : state) {
+        std::vector<Handle> c(v);
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_HandleCopyBig)->RangeMultiplier(8)->Range(1<<6, 1<<14);
+
+// 复制后修改每个元素：写时复制，代价与Surrogate相当
+static void BM_HandleCopyThenWrite(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::vector<Handle> v;
+    for (unsigned i=0; i!=n; i++)
+        v.push_back(Big());
+    for (auto _ : state) {
+        std::vector<Handle> c(v);
+        for (unsigned i=0; i!=n; i++)
+            benchmark::DoNotOptimize(c[i].get());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_HandleCopyThenWrite)->RangeMultiplier(8)->Range(1<<6, 1<<14);
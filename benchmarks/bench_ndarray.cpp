@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+#include "ndarray.h"
+
+// 对比第13章的 Array<Array<int> > 与 NDArray<int, 2>，均为n x n
+
+static void fill(Array<Array<int> > &a, unsigned n)
+{
+    a.resize(n);
+    for (unsigned i=0; i!=n; i++) {
+        a[i].resize(n);
+        for (unsigned j=0; j!=n; j++)
+            a[i][j] = i+j;
+    }
+}
+
+static void fill(NDArray<int, 2> &a, unsigned n)
+{
+    for (unsigned i=0; i!=n; i++)
+        for (unsigned j=0; j!=n; j++)
+            a(i, j) = i+j;
+}
+
+static void BM_NestedRowScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<Array<int> > a;
+    fill(a, n);
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned i=0; i!=n; i++)
+            for (unsigned j=0; j!=n; j++)
+                sum += a[i][j];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NestedRowScan)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_NDArrayRowScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    NDArray<int, 2> a(n, n);
+    fill(a, n);
+    for (auto _ : state) {
+        long sum = 0;
+        a.view().for_each([&sum](int x){ sum += x; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NDArrayRowScan)->RangeMultiplier(4)->Range(64, 4096);
+
+// 按列求和：外层循环是列
+static void BM_NestedColScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<Array<int> > a;
+    fill(a, n);
+    Array<long> sums(n);
+    for (auto _ : state) {
+        for (unsigned j=0; j!=n; j++) {
+            long sum = 0;
+            for (unsigned i=0; i!=n; i++)
+                sum += a[i][j];
+            sums[j] = sum;
+        }
+        benchmark::DoNotOptimize(&sums[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NestedColScan)->RangeMultiplier(4)->Range(64, 4096);
+
+// 按列求和，逐块处理
+static void BM_NDArrayColScanTiled(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    NDArray<int, 2> a(n, n);
+    fill(a, n);
+    Array<long> sums(n);
+    long *s = &sums[0];
+    for (auto _ : state) {
+        for (unsigned j=0; j!=n; j++)
+            s[j] = 0;
+        for_each_tile(a.view(), 64, [s, &a](const NDView<int, 2> &t) {
+            const unsigned j0 = (t.data() - a.view().data()) % a.shape(1);
+            for (unsigned i=0; i!=t.shape(0); i++) {
+                const int *row = t.data() + i*t.stride(0);
+                for (unsigned j=0; j!=t.shape(1); j++)
+                    s[j0+j] += row[j];
+            }
+        });
+        benchmark::DoNotOptimize(s);
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NDArrayColScanTiled)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_NestedTranspose(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<Array<int> > a, b;
+    fill(a, n);
+    fill(b, n);
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++)
+            for (unsigned j=0; j!=n; j++)
+                b[j][i] = a[i][j];
+        benchmark::DoNotOptimize(&b[0][0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NestedTranspose)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_NDArrayTransposeTiled(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    NDArray<int, 2> a(n, n), b(n, n);
+    fill(a, n);
+    for (auto _ : state) {
+        transpose(a.view(), b.view());
+        benchmark::DoNotOptimize(b.view().data());
+    }
+    state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_NDArrayTransposeTiled)->RangeMultiplier(4)->Range(64, 4096);
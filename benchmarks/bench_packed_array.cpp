@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "array.h"
+#include "packed_array.h"
+
+// 两种数据：0..999之间的随机数，以及递增的时间戳
+static Array<unsigned> make(unsigned n, bool sorted)
+{
+    Array<unsigned> a(n);
+    std::mt19937 gen(42);
+    unsigned t = 1600000000;
+    for (unsigned i=0; i!=n; i++) {
+        if (sorted) {
+            t += 1 + gen()%16;
+            a[i] = t;
+        } else {
+            a[i] = gen()%1000;
+        }
+    }
+    return a;
+}
+
+static void BM_ArrayScan(benchmark::State &state)
+{
+    Array<unsigned> a = make(state.range(0), state.range(1));
+    const unsigned *p = &a[0];
+    for (auto _ : state) {
+        unsigned long long sum = 0;
+        for (unsigned i=0; i!=a.size(); i++)
+            sum += p[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+    state.counters["bytes"] = double(a.size())*sizeof(unsigned);
+}
+BENCHMARK(BM_ArrayScan)->ArgsProduct({{1<<20}, {0, 1}});
+
+static void BM_PackedScan(benchmark::State &state)
+{
+    PackedArray<unsigned> p(make(state.range(0), state.range(1)));
+    for (auto _ : state) {
+        unsigned long long sum = 0;
+        p.for_each([&](unsigned v) { sum += v; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * p.size());
+    state.counters["bytes"] = double(p.bytes());
+    state.counters["ratio"] = p.ratio();
+}
+BENCHMARK(BM_PackedScan)->ArgsProduct({{1<<20}, {0, 1}});
+
+// 随机访问
+static void BM_ArrayRandomAccess(benchmark::State &state)
+{
+    Array<unsigned> a = make(state.range(0), state.range(1));
+    std::mt19937 gen(7);
+    for (auto _ : state) {
+        unsigned long long sum = 0;
+        for (unsigned k=0; k!=1024; k++)
+            sum += a[gen()%a.size()];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_ArrayRandomAccess)->ArgsProduct({{1<<20}, {0, 1}});
+
+static void BM_PackedRandomAccess(benchmark::State &state)
+{
+    PackedArray<unsigned> p(make(state.range(0), state.range(1)));
+    std::mt19937 gen(7);
+    for (auto _ : state) {
+        unsigned long long sum = 0;
+        for (unsigned k=0; k!=1024; k++)
+            sum += p[gen()%p.size()];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_PackedRandomAccess)->ArgsProduct({{1<<20}, {0, 1}});
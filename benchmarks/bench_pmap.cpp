@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <random>
+#include <vector>
+#include "pmap.h"
+
+// 从n个键的表开始，每次修改一个键并保留修改前的版本。
+// std::map要保留旧版本只能整个复制；PMap只复制一条路径
+static void BM_StdMapCopyPerVersion(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::map<unsigned, unsigned> m;
+    for (unsigned i=0; i!=n; i++)
+        m[i*7] = i;
+    std::mt19937 gen(1);
+    for (auto _ : state) {
+        std::map<unsigned, unsigned> next(m);
+        next[(gen()%n)*7] = 1;
+        benchmark::DoNotOptimize(next.size());
+        m.swap(next);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StdMapCopyPerVersion)->RangeMultiplier(16)->Range(1<<8, 1<<16);
+
+static void BM_PMapVersion(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    PMap<unsigned, unsigned> m;
+    for (unsigned i=0; i!=n; i++)
+        m = m.insert(i*7, i);
+    std::mt19937 gen(1);
+    for (auto _ : state) {
+        PMap<unsigned, unsigned> next = m.insert((gen()%n)*7, 1);
+        benchmark::DoNotOptimize(next.size());
+        m = next;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PMapVersion)->RangeMultiplier(16)->Range(1<<8, 1<<16);
+
+// 查找
+static void BM_StdMapFind(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::map<unsigned, unsigned> m;
+    for (unsigned i=0; i!=n; i++)
+        m[i*7] = i;
+    std::mt19937 gen(2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(m.find((gen()%n)*7));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StdMapFind)->RangeMultiplier(16)->Range(1<<8, 1<<16);
+
+static void BM_PMapFind(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    PMap<unsigned, unsigned> m;
+    for (unsigned i=0; i!=n; i++)
+        m = m.insert(i*7, i);
+    std::mt19937 gen(2);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(m.find((gen()%n)*7));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PMapFind)->RangeMultiplier(16)->Range(1<<8, 1<<16);
+
+// 遍历一个快照
+static void BM_PMapSnapshotIterate(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    PMap<unsigned, unsigned> m;
+    for (unsigned i=0; i!=n; i++)
+        m = m.insert(i, i);
+    for (auto _ : state) {
+        unsigned long sum = 0;
+        for (PMapCursor<unsigned, unsigned> c(m); c; ++c)
+            sum += c.value();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_PMapSnapshotIterate)->Arg(1<<16);
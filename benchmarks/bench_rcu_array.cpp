@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "array.h"
+#include "rcu_array.h"
+
+// 一个写者不断增长数组(到一定大小后重新开始)的同时，读者随机读取64个元素。
+// 对照组用一把锁保护Array，读者与写者互相等待。
+enum { LIMIT = 1 << 16, READS = 64 };
+
+static void BM_LockedArrayReadDuringGrowth(benchmark::State &state)
+{
+    Array<unsigned> a(1);
+    unsigned used = 1;
+    a[0] = 0;
+    std::mutex m;
+    std::atomic<bool> stop(false);
+    std::thread writer([&]{
+        while (!stop) {
+            std::lock_guard<std::mutex> lock(m);
+            if (used==LIMIT) {
+                a.resize(1);
+                used = 1;
+            }
+            a.reserve(used);
+            a[used] = used;
+            used++;
+        }
+    });
+    std::mt19937 gen(3);
+    for (auto _ : state) {
+        unsigned long sum = 0;
+        std::lock_guard<std::mutex> lock(m);
+        for (unsigned k=0; k!=READS; k++)
+            sum += a[gen()%used];
+        benchmark::DoNotOptimize(sum);
+    }
+    stop = true;
+    writer.join();
+    state.SetItemsProcessed(state.iterations() * READS);
+}
+BENCHMARK(BM_LockedArrayReadDuringGrowth)->UseRealTime();
+
+static void BM_RcuArrayReadDuringGrowth(benchmark::State &state)
+{
+    RcuArray<unsigned> a;
+    a.push_back(0);
+    std::atomic<bool> stop(false);
+    std::thread writer([&]{
+        while (!stop) {
+            if (a.size()==LIMIT)
+                a.resize(1);
+            a.push_back(a.size());
+        }
+    });
+    std::mt19937 gen(3);
+    for (auto _ : state) {
+        unsigned long sum = 0;
+        RcuSnapshot<unsigned> s = a.snapshot();
+        for (unsigned k=0; k!=READS; k++)
+            sum += s[gen()%s.size()];
+        benchmark::DoNotOptimize(sum);
+    }
+    stop = true;
+    writer.join();
+    state.SetItemsProcessed(state.iterations() * READS);
+}
+BENCHMARK(BM_RcuArrayReadDuringGrowth)->UseRealTime();
+
+// 没有写者时快照本身的开销
+static void BM_RcuSnapshot(benchmark::State &state)
+{
+    RcuArray<unsigned> a(16);
+    for (auto _ : state) {
+        RcuSnapshot<unsigned> s = a.snapshot();
+        benchmark::DoNotOptimize(s.size());
+    }
+}
+BENCHMARK(BM_RcuSnapshot);
@@ -0,0 +1,193 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+#include "ring_buffer.h"
+
+// 生产者固定在0号CPU上，消费者(或回应者)在最后一个参数指定的CPU上，比较同一核心、
+// 超线程兄弟与不同核心之间的差别。CPU不够时不绑定。
+enum { ITEMS = 1 << 20, CAPACITY = 1024 };
+
+static void pin(unsigned cpu)
+{
+#ifdef __linux__
+    if (cpu>=std::thread::hardware_concurrency())
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+#else
+    (void)cpu;
+#endif
+}
+
+static void unpin()
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned c=0; c!=std::thread::hardware_concurrency(); c++)
+        CPU_SET(c, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+#endif
+}
+
+static unsigned cpus()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n==0 ? 1 : n<4 ? n : 4;
+}
+
+static void CorePairs(benchmark::internal::Benchmark *b)
+{
+    for (long batch : {1, 32})
+        for (unsigned c=0; c!=cpus(); c++)
+            b->Args({batch, long(c)});
+}
+
+// 吞吐量：每次迭代传递ITEMS个元素，每次push/pop处理range(0)个
+static void BM_SpscThroughput(benchmark::State &state)
+{
+    const unsigned batch = state.range(0);
+    pin(0);
+    for (auto _ : state) {
+        SpscRing<unsigned> q(CAPACITY);
+        std::thread consumer([&]{
+            pin(state.range(1));
+            std::vector<unsigned> b(batch);
+            unsigned long sum = 0;
+            for (unsigned got=0; got!=ITEMS; ) {
+                unsigned k = q.pop(b.data(), batch);
+                if (k==0) std::this_thread::yield();
+                for (unsigned i=0; i!=k; i++)
+                    sum += b[i];
+                got += k;
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+        std::vector<unsigned> b(batch);
+        for (unsigned i=0; i<ITEMS; ) {
+            unsigned k = batch<ITEMS-i ? batch : ITEMS-i;
+            for (unsigned j=0; j!=k; j++)
+                b[j] = i+j;
+            unsigned done = 0;
+            while (done!=k)
+                if (unsigned d = q.push(b.data()+done, k-done))
+                    done += d;
+                else
+                    std::this_thread::yield();
+            i += k;
+        }
+        consumer.join();
+    }
+    unpin();
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_SpscThroughput)->Apply(CorePairs)->UseRealTime();
+
+static void BM_MpmcThroughput(benchmark::State &state)
+{
+    const unsigned batch = state.range(0);
+    pin(0);
+    for (auto _ : state) {
+        MpmcRing<unsigned> q(CAPACITY);
+        std::thread consumer([&]{
+            pin(state.range(1));
+            std::vector<unsigned> b(batch);
+            unsigned long sum = 0;
+            for (unsigned got=0; got!=ITEMS; ) {
+                unsigned k = q.pop(b.data(), batch);
+                if (k==0) std::this_thread::yield();
+                for (unsigned i=0; i!=k; i++)
+                    sum += b[i];
+                got += k;
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+        std::vector<unsigned> b(batch);
+        for (unsigned i=0; i<ITEMS; ) {
+            unsigned k = batch<ITEMS-i ? batch : ITEMS-i;
+            for (unsigned j=0; j!=k; j++)
+                b[j] = i+j;
+            unsigned done = 0;
+            while (done!=k)
+                if (unsigned d = q.push(b.data()+done, k-done))
+                    done += d;
+                else
+                    std::this_thread::yield();
+            i += k;
+        }
+        consumer.join();
+    }
+    unpin();
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_MpmcThroughput)->Apply(CorePairs)->UseRealTime();
+
+// 对照：用一把锁保护std::queue
+static void BM_LockedQueueThroughput(benchmark::State &state)
+{
+    for (auto _ : state) {
+        std::queue<unsigned> q;
+        std::mutex m;
+        std::thread consumer([&]{
+            unsigned long sum = 0;
+            for (unsigned got=0; got!=ITEMS; ) {
+                std::unique_lock<std::mutex> lock(m);
+                if (q.empty()) {
+                    lock.unlock();
+                    std::this_thread::yield();
+                    continue;
+                }
+                sum += q.front();
+                q.pop();
+                got++;
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+        for (unsigned i=0; i!=ITEMS; i++) {
+            std::lock_guard<std::mutex> lock(m);
+            q.push(i);
+        }
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+BENCHMARK(BM_LockedQueueThroughput)->UseRealTime();
+
+// 延迟：一个元素经两个SpscRing往返一次的时间
+static void BM_SpscPingPong(benchmark::State &state)
+{
+    SpscRing<unsigned> to(CAPACITY), from(CAPACITY);
+    std::atomic<bool> stop(false);
+    pin(0);
+    std::thread echo([&]{
+        pin(state.range(0));
+        unsigned v;
+        while (!stop.load(std::memory_order_relaxed))
+            if (to.pop(v))
+                while (!from.push(v))
+                    ;
+            else
+                std::this_thread::yield();
+    });
+    unsigned v = 0;
+    for (auto _ : state) {
+        while (!to.push(v))
+            ;
+        unsigned r;
+        while (!from.pop(r))
+            std::this_thread::yield();
+        v = r+1;
+    }
+    stop = true;
+    echo.join();
+    unpin();
+}
+BENCHMARK(BM_SpscPingPong)->DenseRange(0, cpus()-1)->UseRealTime();
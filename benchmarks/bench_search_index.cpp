@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include "array.h"
+#include "search_index.h"
+
+// 在n个有序的int中查找随机的键。n从装得进L1到远大于最后一级缓存
+enum { LOOKUPS = 1 << 12 };
+
+static Array<int> sorted_array(unsigned n)
+{
+    Array<int> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i] = 2*i;
+    return a;
+}
+
+static std::vector<int> random_keys(unsigned n)
+{
+    std::mt19937 gen(5);
+    std::vector<int> xs(LOOKUPS);
+    for (unsigned i=0; i!=LOOKUPS; i++)
+        xs[i] = gen() % (2*n);
+    return xs;
+}
+
+// 对照：在ArrayData的缓冲区上直接做二分查找
+static void BM_StdLowerBound(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> a = sorted_array(n);
+    const int *begin = &a[0], *end = begin + n;
+    std::vector<int> xs = random_keys(n);
+    for (auto _ : state) {
+        unsigned long sum = 0;
+        for (unsigned i=0; i!=LOOKUPS; i++)
+            sum += std::lower_bound(begin, end, xs[i]) - begin;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_StdLowerBound)->RangeMultiplier(8)->Range(1<<10, 1<<25);
+
+static void BM_EytzingerLowerBound(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    EytzingerIndex<int> idx(sorted_array(n));
+    std::vector<int> xs = random_keys(n);
+    for (auto _ : state) {
+        unsigned long sum = 0;
+        for (unsigned i=0; i!=LOOKUPS; i++)
+            sum += idx.lower_bound(xs[i]);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_EytzingerLowerBound)->RangeMultiplier(8)->Range(1<<10, 1<<25);
+
+static void BM_EytzingerBatchLowerBound(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    EytzingerIndex<int> idx(sorted_array(n));
+    std::vector<int> xs = random_keys(n);
+    std::vector<unsigned> out(LOOKUPS);
+    for (auto _ : state) {
+        idx.lower_bound(xs.data(), LOOKUPS, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_EytzingerBatchLowerBound)->RangeMultiplier(8)->Range(1<<10, 1<<25);
+
+static void BM_EytzingerBatchContains(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    EytzingerIndex<int> idx(sorted_array(n));
+    std::vector<int> xs = random_keys(n);
+    std::unique_ptr<bool[]> out(new bool[LOOKUPS]);
+    for (auto _ : state) {
+        unsigned hits = idx.contains(xs.data(), LOOKUPS, out.get());
+        benchmark::DoNotOptimize(hits);
+    }
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_EytzingerBatchContains)->RangeMultiplier(8)->Range(1<<10, 1<<25);
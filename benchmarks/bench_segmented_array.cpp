@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "array.h"
+#include "segmented_array.h"
+
+// 多个线程共追加n个元素：Array需要一把锁，增长时所有线程都要等待重新分配
+static void BM_ArrayLockedAppend(benchmark::State &state)
+{
+    const unsigned n = state.range(0), threads = state.range(1);
+    for (auto _ : state) {
+        Array<unsigned> a;
+        unsigned used = 0;
+        std::mutex m;
+        std::vector<std::thread> ts;
+        for (unsigned t=0; t!=threads; t++)
+            ts.push_back(std::thread([&, t]{
+                for (unsigned k=0; k!=n/threads; k++) {
+                    std::lock_guard<std::mutex> lock(m);
+                    a.reserve(used);
+                    a[used++] = k;
+                }
+            }));
+        for (unsigned t=0; t!=threads; t++)
+            ts[t].join();
+        benchmark::DoNotOptimize(&a);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayLockedAppend)->ArgsProduct({{1<<16, 1<<20}, {1, 2, 4}})->UseRealTime();
+
+static void BM_SegmentedAppend(benchmark::State &state)
+{
+    const unsigned n = state.range(0), threads = state.range(1);
+    for (auto _ : state) {
+        SegmentedArray<unsigned> a;
+        std::vector<std::thread> ts;
+        for (unsigned t=0; t!=threads; t++)
+            ts.push_back(std::thread([&]{
+                for (unsigned k=0; k!=n/threads; k++)
+                    a.push_back(k);
+            }));
+        for (unsigned t=0; t!=threads; t++)
+            ts[t].join();
+        benchmark::DoNotOptimize(&a);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SegmentedAppend)->ArgsProduct({{1<<16, 1<<20}, {1, 2, 4}})->UseRealTime();
+
+static void BM_SegmentedIndexScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    SegmentedArray<unsigned> a;
+    for (unsigned i=0; i!=n; i++)
+        a.push_back(i);
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned i=0; i!=n; i++)
+            sum += a[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SegmentedIndexScan)->RangeMultiplier(8)->Range(1<<10, 1<<20);
@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+#include "seq.h"
+#include "pvector.h"
+#include "array.h"
+
+static Seq<int> build(unsigned n)
+{
+    Seq<int> s;
+    for (unsigned i=0; i!=n; i++)
+        s = Seq<int>(i, s);
+    return s;
+}
+
+static void BM_SeqCons(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Seq<int> s = build(n);
+        benchmark::DoNotOptimize(&s);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SeqCons)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_SeqInternedCons(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Seq<int>::interning(true);
+    Seq<int> keep = build(n);   // 所有的cons都会命中驻留表
+    for (auto _ : state) {
+        Seq<int> s = build(n);
+        benchmark::DoNotOptimize(&s);
+    }
+    Seq<int>::interning(false);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SeqInternedCons)->RangeMultiplier(8)->Range(1<<10, 1<<18);
+
+static void BM_SeqTraverse(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Seq<int> s = build(n);
+    for (auto _ : state) {
+        long sum = 0;
+        for (Seq<int> i = s; i; ++i)
+            sum += *i;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SeqTraverse)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+// 每次迭代生成一个修改了一个元素的新版本
+static void BM_PVectorVersion(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    TransientPVector<int> t;
+    for (unsigned i=0; i!=n; i++)
+        t.push_back(i);
+    PVector<int> v = t.persistent();
+    unsigned k = 0;
+    for (auto _ : state) {
+        v = v.set((k*7919) % n, k);
+        ++k;
+    }
+}
+BENCHMARK(BM_PVectorVersion)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_ArrayCopyVersion(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> *v = new Array<int>(n);
+    unsigned k = 0;
+    for (auto _ : state) {
+        Array<int> *next = new Array<int>(*v);
+        (*next)[(k*7919) % n] = k;
+        delete v;
+        v = next;
+        ++k;
+    }
+    delete v;
+}
+BENCHMARK(BM_ArrayCopyVersion)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_PVectorGet(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    TransientPVector<int> t;
+    for (unsigned i=0; i!=n; i++)
+        t.push_back(i);
+    PVector<int> v = t.persistent();
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned i=0, j=0; i!=n; i++, j=(j+7919)%n)
+            sum += v[j];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_PVectorGet)->RangeMultiplier(8)->Range(1<<10, 1<<20);
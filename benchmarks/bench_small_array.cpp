@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+#include "small_array.h"
+
+// 创建并销毁n个只有4个元素的数组
+static void BM_ArrayShortLived(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++) {
+            Array<int> a(4);
+            a[3] = i;
+            benchmark::DoNotOptimize(&a);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ArrayShortLived)->Arg(1<<16);
+
+static void BM_SmallArrayShortLived(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++) {
+            SmallArray<int, 8> a(4);
+            a[3] = i;
+            benchmark::DoNotOptimize(&a);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SmallArrayShortLived)->Arg(1<<16);
+
+// 创建n行、每行4个元素的二维数组，然后销毁
+static void BM_NestedArrayRows(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Array<Array<int> > rows(n);
+        for (unsigned i=0; i!=n; i++)
+            rows[i].resize(4);
+        benchmark::DoNotOptimize(&rows);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NestedArrayRows)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_NestedSmallArrayRows(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    for (auto _ : state) {
+        Array<SmallArray<int, 8> > rows(n);
+        for (unsigned i=0; i!=n; i++)
+            rows[i].resize(4);
+        benchmark::DoNotOptimize(&rows);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NestedSmallArrayRows)->RangeMultiplier(8)->Range(1<<10, 1<<20);
@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include "array.h"
+#include "soa.h"
+
+// 40字节的记录，只扫描其中的一个float字段
+struct Record{
+    float price;
+    float qty;
+    double ts;
+    long id;
+    int flags;
+    float extra[3];
+};
+
+typedef SoaArray<Record,
+                 SOA_FIELD(Record, price), SOA_FIELD(Record, qty),
+                 SOA_FIELD(Record, ts), SOA_FIELD(Record, id),
+                 SOA_FIELD(Record, flags)> Records;
+
+static void BM_AosFieldScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<Record> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i].price = i;
+    const Record *r = &a[0];
+    for (auto _ : state) {
+        float sum = 0;
+        for (unsigned i=0; i!=n; i++)
+            sum += r[i].price;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(float));
+}
+BENCHMARK(BM_AosFieldScan)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+static void BM_SoaFieldScan(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Records a(n);
+    float *price = a.column<0>();
+    for (unsigned i=0; i!=n; i++)
+        price[i] = i;
+    for (auto _ : state) {
+        float sum = 0;
+        for (unsigned i=0; i!=n; i++)
+            sum += price[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(state.iterations() * n * sizeof(float));
+}
+BENCHMARK(BM_SoaFieldScan)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+// price *= qty：两个字段的逐元素运算，SoA版本可以向量化
+static void BM_AosKernel(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<Record> a(n);
+    for (unsigned i=0; i!=n; i++) {
+        a[i].price = 1;
+        a[i].qty = 1.0001f;
+    }
+    Record *r = &a[0];
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++)
+            r[i].price *= r[i].qty;
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_AosKernel)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+static void BM_SoaKernel(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Records a(n);
+    float *__restrict price = a.column<0>();
+    const float *__restrict qty = a.column<1>();
+    for (unsigned i=0; i!=n; i++) {
+        price[i] = 1;
+        a.column<1>()[i] = 1.0001f;
+    }
+    for (auto _ : state) {
+        for (unsigned i=0; i!=n; i++)
+            price[i] *= qty[i];
+        benchmark::DoNotOptimize(price);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SoaKernel)->RangeMultiplier(8)->Range(1<<10, 1<<22);
+
+// 通过代理读写整条记录
+static void BM_SoaRecordLoad(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Records a(n);
+    for (auto _ : state) {
+        double sum = 0;
+        for (unsigned i=0; i!=n; i++) {
+            Record r = a[i];
+            sum += r.price + r.ts;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SoaRecordLoad)->RangeMultiplier(8)->Range(1<<10, 1<<20);
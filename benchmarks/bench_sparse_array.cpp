@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include "array.h"
+#include "sparse_array.h"
+
+// n个下标中随机写入n/density个元素，然后求和
+static void BM_ArraySparseFill(benchmark::State &state)
+{
+    const unsigned n = state.range(0), m = n/state.range(1);
+    for (auto _ : state) {
+        std::mt19937 gen(1);
+        Array<int> a(n);
+        for (unsigned k=0; k!=m; k++)
+            a[gen()%n] = k+1;
+        long sum = 0;
+        const int *p = &a[0];
+        for (unsigned i=0; i!=n; i++)
+            sum += p[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * m);
+    state.counters["bytes"] = double(n)*sizeof(int);
+}
+BENCHMARK(BM_ArraySparseFill)->ArgsProduct({{1<<22}, {16, 1024, 65536}})->Unit(benchmark::kMicrosecond);
+
+static void BM_SparseArrayFill(benchmark::State &state)
+{
+    const unsigned n = state.range(0), m = n/state.range(1);
+    std::size_t bytes = 0;
+    for (auto _ : state) {
+        std::mt19937 gen(1);
+        SparseArray<int> a(n);
+        for (unsigned k=0; k!=m; k++)
+            a[gen()%n] = k+1;
+        long sum = 0;
+        a.for_each([&](unsigned, int v) { sum += v; });
+        benchmark::DoNotOptimize(sum);
+        bytes = a.bytes();
+    }
+    state.SetItemsProcessed(state.iterations() * m);
+    state.counters["bytes"] = double(bytes);
+}
+BENCHMARK(BM_SparseArrayFill)->ArgsProduct({{1<<22}, {16, 1024, 65536}})->Unit(benchmark::kMicrosecond);
+
+// 随机读取
+static void BM_ArrayRandomRead(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Array<int> a(n);
+    std::mt19937 gen(2);
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned k=0; k!=1024; k++)
+            sum += a[gen()%n];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_ArrayRandomRead)->Arg(1<<22);
+
+static void BM_SparseArrayRandomRead(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    SparseArray<int> a(n);
+    for (unsigned i=0; i<n; i+=n/64)
+        a[i] = 1;
+    const SparseArray<int> &ca = a;
+    std::mt19937 gen(2);
+    for (auto _ : state) {
+        long sum = 0;
+        for (unsigned k=0; k!=1024; k++)
+            sum += ca[gen()%n];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_SparseArrayRandomRead)->Arg(1<<22);
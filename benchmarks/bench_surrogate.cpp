@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "surrogate.h"
+
+// 向vector<Surrogate>中添加n个对象，每个对象克隆一次
+static void BM_SurrogateConstruct(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Sub1 s;
+    for (auto _ : state) {
+        std::vector<Surrogate> v;
+        v.reserve(n);
+        for (unsigned i=0; i!=n; i++)
+            v.push_back(s);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateConstruct)->RangeMultiplier(8)->Range(1<<10, 1<<18);
+
+// 复制vector<Surrogate>，每个元素都要克隆其所代理的对象
+static void BM_SurrogateCopy(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::vector<Surrogate> v(n, Surrogate(Sub2()));
+    for (auto _ : state) {
+        std::vector<Surrogate> c(v);
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateCopy)->RangeMultiplier(8)->Range(1<<10, 1<<18);
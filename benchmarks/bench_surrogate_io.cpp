@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <vector>
+#include "surrogate_io.h"
+
+static std::string snapshot(unsigned n)
+{
+    std::vector<Surrogate> v;
+    v.reserve(n);
+    for (unsigned i=0; i!=n; i++) {
+        if (i%3==0) v.push_back(Super());
+        else if (i%3==1) v.push_back(Sub1());
+        else v.push_back(Sub2());
+    }
+    std::ostringstream os;
+    write_surrogates(os, v);
+    return os.str();
+}
+
+static void BM_SurrogateWrite(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    std::istringstream is(snapshot(n));
+    std::vector<Surrogate> v;
+    read_surrogates(is, v);
+    for (auto _ : state) {
+        std::ostringstream os;
+        write_surrogates(os, v);
+        benchmark::DoNotOptimize(os.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateWrite)->RangeMultiplier(8)->Range(1<<12, 1<<21);
+
+// 对照：从一组原型逐个clone()重建
+static void BM_SurrogateRebuildByClone(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    Super s0; Sub1 s1; Sub2 s2;
+    const Super *proto[3] = {&s0, &s1, &s2};
+    for (auto _ : state) {
+        std::vector<Surrogate> v;
+        v.reserve(n);
+        for (unsigned i=0; i!=n; i++)
+            v.push_back(*proto[i%3]);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateRebuildByClone)->RangeMultiplier(8)->Range(1<<12, 1<<21);
+
+// 每个对象单独在堆上分配
+static void BM_SurrogateReadHeap(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    const std::string bytes = snapshot(n);
+    for (auto _ : state) {
+        std::istringstream is(bytes);
+        std::vector<Surrogate> v;
+        read_surrogates(is, v);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateReadHeap)->RangeMultiplier(8)->Range(1<<12, 1<<21);
+
+// 所有对象构造在一个SurrogateArena中
+static void BM_SurrogateReadArena(benchmark::State &state)
+{
+    const unsigned n = state.range(0);
+    const std::string bytes = snapshot(n);
+    for (auto _ : state) {
+        std::istringstream is(bytes);
+        SurrogateArena arena;
+        std::vector<Surrogate> v;
+        read_surrogates(is, v, arena);
+        benchmark::DoNotOptimize(v.data());
+        v.clear();      // 先于arena销毁
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SurrogateReadArena)->RangeMultiplier(8)->Range(1<<12, 1<<21);
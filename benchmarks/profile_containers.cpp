@@ -0,0 +1,76 @@
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "profile.h"
+#include "array.h"
+#include "surrogate.h"
+#include "seq.h"
+
+// 用profile.h剖析几种容器的基本操作，以JSON输出硬件计数器与延迟分布：
+//     profile_containers [输出文件]
+// 与benchmarks不同，这里关心的是每次操作的代价从哪里来(缓存未命中、分支预测失败、分配)
+// 以及延迟的尾部，而不只是平均吞吐量。Histogram等本身的检查在part3/ch14/ch14_profile.cpp中。
+
+static volatile long long sink;
+
+int main(int argc, char *argv[])
+{
+    const unsigned n = 1 << 22;
+    Array<int> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i] = i;
+    std::vector<unsigned> random(n);
+    std::mt19937 gen(42);
+    for (unsigned i=0; i!=n; i++)
+        random[i] = gen() % n;
+
+    std::vector<profile::Report> reports;
+
+    // ArrayData::operator[]：顺序访问与随机访问(后者几乎每次都缓存未命中)
+    long long sum = 0;
+    reports.push_back(profile::run("array_index_sequential", n,
+                                   [&](unsigned long long i) {sum += a[unsigned(i)];}, 64));
+    reports.push_back(profile::run("array_index_random", n,
+                                   [&](unsigned long long i) {sum += a[random[i]];}, 64));
+
+    // 通过Pointer遍历：每次解引用都要检查是否绑定以及下标是否越界
+    Pointer<int> p(a);
+    reports.push_back(profile::run("pointer_deref", n,
+                                   [&](unsigned long long) {sum += *p; ++p;}, 64));
+
+    // Surrogate的每次复制都克隆并分配一个对象；逐个计时以看到分配器的尾部延迟
+    const unsigned objects = 1 << 18;
+    std::vector<Surrogate> v;
+    v.reserve(objects);
+    Sub1 s1;
+    reports.push_back(profile::run("surrogate_clone", objects,
+                                   [&](unsigned long long) {v.push_back(s1);}));
+
+    // Seq的遍历：每走一步都要调整引用计数，节点在堆中分散
+    const unsigned items = 1 << 20;
+    Seq<int> seq;
+    for (unsigned i=0; i!=items; i++)
+        seq = Seq<int>(i, seq);
+    Seq<int> it = seq;
+    reports.push_back(profile::run("seq_traverse", items,
+                                   [&](unsigned long long) {sum += *it; ++it;}, 64));
+    assert(!it);
+    sink = sum;
+
+    std::ostringstream os;
+    os << "{\"hardware_counters\": " << (profile::Counters().available() ? "true" : "false")
+       << ", \"reports\": [";
+    for (unsigned i=0; i!=reports.size(); i++)
+        os << (i ? ",\n    " : "\n    ") << reports[i].to_json();
+    os << "\n]}\n";
+
+    if (argc>1) {
+        std::ofstream out(argv[1]);
+        out << os.str();
+    } else {
+        std::cout << os.str();
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#ifndef ARRAY_EXPR_H
+#define ARRAY_EXPR_H
+
+#include <type_traits>
+#include "array.h"
+
+// 表达式模板
+// 如果operator+返回一个新的Array，c = a + b*k 会产生两个临时数组，遍历三遍。
+// 这里的运算符只返回描述表达式的小对象，Array::operator=在一个循环中
+// 对每个下标计算整个表达式，既不分配中间数组，循环也便于编译器向量化。
+// 表达式中的Array必须一样长，否则抛出异常；表达式对象只保存各Array元素的地址，
+// 所以不能比其中的Array活得更久，也不能在构造之后改变其中Array的大小。
+
+// 所有表达式的基类(CRTP)
+// 每个表达式类有一个静态常量is_scalar，标量可以与任意长度(包括0)的表达式运算
+template<typename E>
+class ArrayExpr{
+public:
+    const E &self() const {return static_cast<const E &>(*this);}
+};
+
+// 叶子：一个Array
+template<typename T>
+class ArrayLeaf:public ArrayExpr<ArrayLeaf<T> >{
+public:
+    static const bool is_scalar = false;
+    ArrayLeaf(const Array<T> &a):d(a.pa->data), n(a.pa->sz) {}
+    const T &operator[](unsigned i) const {return d[i];}
+    unsigned size() const {return n;}
+private:
+    const T *d;
+    unsigned n;
+};
+
+// 叶子：一个标量，可以与任意长度的表达式运算
+template<typename T>
+class ScalarExpr:public ArrayExpr<ScalarExpr<T> >{
+public:
+    static const bool is_scalar = true;
+    ScalarExpr(const T &v):v(v) {}
+    const T &operator[](unsigned) const {return v;}
+    unsigned size() const {return 0;}
+private:
+    T v;
+};
+
+template<typename L, typename R, typename Op>
+class BinaryExpr:public ArrayExpr<BinaryExpr<L, R, Op> >{
+public:
+    static const bool is_scalar = L::is_scalar && R::is_scalar;
+    // 长度由非标量的一边决定；两边都不是标量时必须一样长
+    BinaryExpr(const L &l, const R &r):l(l), r(r), n(L::is_scalar ? r.size() : l.size()) {
+        if (!L::is_scalar && !R::is_scalar && l.size()!=r.size())
+            throw "Array expression size mismatch.";
+    }
+    auto operator[](unsigned i) const -> decltype(Op::apply(std::declval<L>()[i], std::declval<R>()[i])) {
+        return Op::apply(l[i], r[i]);
+    }
+    unsigned size() const {return n;}
+private:
+    // 子表达式按值保存，它们都只是几个指针大小的对象
+    L l;
+    R r;
+    unsigned n;
+};
+
+template<typename L>
+class NegateExpr:public ArrayExpr<NegateExpr<L> >{
+public:
+    static const bool is_scalar = L::is_scalar;
+    NegateExpr(const L &l):l(l) {}
+    auto operator[](unsigned i) const -> decltype(-std::declval<L>()[i]) {return -l[i];}
+    unsigned size() const {return l.size();}
+private:
+    L l;
+};
+
+struct AddOp{
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a+b) {return a+b;}
+};
+struct SubOp{
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a-b) {return a-b;}
+};
+struct MulOp{
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a*b) {return a*b;}
+};
+struct DivOp{
+    template<typename A, typename B>
+    static auto apply(const A &a, const B &b) -> decltype(a/b) {return a/b;}
+};
+
+// 把运算符的操作数变成表达式：Array变成ArrayLeaf，表达式不变，其他的当作标量
+template<typename X, bool = std::is_base_of<ArrayExpr<X>, X>::value>
+struct ExprOperand{
+    static const bool is_array = false;
+    typedef ScalarExpr<X> type;
+    static type wrap(const X &x) {return type(x);}
+};
+template<typename X>
+struct ExprOperand<X, true>{
+    static const bool is_array = true;
+    typedef X type;
+    static const X &wrap(const X &x) {return x;}
+};
+template<typename T>
+struct ExprOperand<Array<T>, false>{
+    static const bool is_array = true;
+    typedef ArrayLeaf<T> type;
+    static type wrap(const Array<T> &a) {return type(a);}
+};
+
+// 至少有一个操作数是Array或表达式时，运算符才参与重载
+#define ARRAY_EXPR_OPERATOR(op, Op)                                              \
+template<typename A, typename B,                                                 \
+         typename = typename std::enable_if<ExprOperand<A>::is_array ||          \
+                                            ExprOperand<B>::is_array>::type>     \
+BinaryExpr<typename ExprOperand<A>::type, typename ExprOperand<B>::type, Op>     \
+operator op(const A &a, const B &b)                                              \
+{                                                                                \
+    return BinaryExpr<typename ExprOperand<A>::type,                             \
+                      typename ExprOperand<B>::type, Op>(                        \
+        ExprOperand<A>::wrap(a), ExprOperand<B>::wrap(b));                       \
+}
+
+ARRAY_EXPR_OPERATOR(+, AddOp)
+ARRAY_EXPR_OPERATOR(-, SubOp)
+ARRAY_EXPR_OPERATOR(*, MulOp)
+ARRAY_EXPR_OPERATOR(/, DivOp)
+
+#undef ARRAY_EXPR_OPERATOR
+
+template<typename A,
+         typename = typename std::enable_if<ExprOperand<A>::is_array>::type>
+NegateExpr<typename ExprOperand<A>::type> operator-(const A &a)
+{
+    return NegateExpr<typename ExprOperand<A>::type>(ExprOperand<A>::wrap(a));
+}
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef ARRAY_LOADER_H
+#define ARRAY_LOADER_H
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#include "array.h"
+
+// 从文件异步的读入Array
+// 先把整个文件读完再计算，读盘和计算就不能重叠。ArrayLoader把文件分成若干块，
+// 同时发出多个读请求，每读完一块就在调用线程中调用回调函数处理这一块，
+// 其余的块仍然在读。块完成的顺序不一定是文件中的顺序。
+// Linux上用io_uring(直接使用系统调用，不依赖liburing)；不可用时由一组读线程各自pread，
+// 这些线程在第一次load时创建，之后的load重复使用，直到ArrayLoader析构。
+// 一个ArrayLoader同一时间只能在一个线程中load。
+
+#ifdef __linux__
+// io_uring的提交队列与完成队列，只支持读操作
+class UringQueue{
+public:
+    // 构造中途抛出异常时，已经打开的fd与已经映射的区域由成员各自的析构函数释放
+    explicit UringQueue(unsigned entries):unsubmitted(0) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof p);
+        ring.fd = int(syscall(__NR_io_uring_setup, entries, &p));
+        if (ring.fd<0)
+            throw "io_uring is not available.";
+        std::size_t sq_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+        std::size_t cq_size = p.cq_off.cqes + p.cq_entries*sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single && cq_size>sq_size)
+            sq_size = cq_size;
+        sq_map.map(ring.fd, sq_size, IORING_OFF_SQ_RING);
+        if (!single)
+            cq_map.map(ring.fd, cq_size, IORING_OFF_CQ_RING);
+        sqe_map.map(ring.fd, p.sq_entries*sizeof(io_uring_sqe), IORING_OFF_SQES);
+        sqes = static_cast<io_uring_sqe *>(sqe_map.p);
+
+        char *sq = static_cast<char *>(sq_map.p);
+        char *cq = static_cast<char *>(single ? sq_map.p : cq_map.p);
+        sq_head = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        cq_head = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+        capacity = p.sq_entries;
+    }
+    unsigned entries() const {return capacity;}
+
+    // 放入一个读请求，tag在完成时原样返回；队列满时返回false
+    bool read(int file, void *buf, unsigned len, unsigned long long off, unsigned long long tag) {
+        unsigned tail = *sq_tail;
+        if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == capacity)
+            return false;
+        unsigned idx = tail & sq_mask;
+        io_uring_sqe *sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof *sqe);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = file;
+        sqe->addr = reinterpret_cast<unsigned long long>(buf);
+        sqe->len = len;
+        sqe->off = off;
+        sqe->user_data = tag;
+        sq_array[idx] = idx;
+        __atomic_store_n(sq_tail, tail+1, __ATOMIC_RELEASE);
+        unsubmitted++;
+        return true;
+    }
+
+    // 提交所有放入的请求，并等待至少wait个完成
+    void submit(unsigned wait) {
+        for (;;) {
+            long r = syscall(__NR_io_uring_enter, ring.fd, unsubmitted, wait,
+                             wait ? IORING_ENTER_GETEVENTS : 0, (void *)0, 0);
+            if (r>=0) {
+                unsubmitted -= unsigned(r);
+                return;
+            }
+            if (errno!=EINTR && errno!=EAGAIN && errno!=EBUSY)
+                throw "io_uring_enter failed.";
+        }
+    }
+
+    // 取出一个完成的请求：res是读到的字节数或-errno
+    bool complete(unsigned long long &tag, int &res) {
+        unsigned head = *cq_head;
+        if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+            return false;
+        const io_uring_cqe &cqe = cqes[head & cq_mask];
+        tag = cqe.user_data;
+        res = cqe.res;
+        __atomic_store_n(cq_head, head+1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    UringQueue(const UringQueue &);
+    UringQueue &operator=(const UringQueue &);
+
+    struct Fd{
+        Fd():fd(-1) {}
+        ~Fd() {if (fd>=0) close(fd);}
+        int fd;
+    };
+    // 一段共享映射，析构时解除
+    struct Mapping{
+        Mapping():p(0), size(0) {}
+        ~Mapping() {if (p) munmap(p, size);}
+        void map(int fd, std::size_t n, unsigned long long off) {
+            void *q = mmap(0, n, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd, off);
+            if (q==MAP_FAILED)
+                throw "io_uring mmap failed.";
+            p = q;
+            size = n;
+        }
+        void *p;
+        std::size_t size;
+    };
+
+    // 按这个顺序构造，析构时先解除映射再关闭fd
+    Fd ring;
+    Mapping sq_map, cq_map, sqe_map;   // 内核支持单一映射时cq_map不用
+    io_uring_sqe *sqes;
+    unsigned *sq_head, *sq_tail, *sq_array, sq_mask;
+    unsigned *cq_head, *cq_tail, cq_mask;
+    io_uring_cqe *cqes;
+    unsigned capacity;
+    unsigned unsubmitted;
+};
+#endif
+
+class ArrayLoader{
+public:
+    enum Backend { AUTO, URING, THREADS };
+
+    // depth：io_uring同时进行的读请求数；threads：不用io_uring时的读线程数
+    ArrayLoader(Backend b=AUTO, unsigned depth=16, unsigned threads=4)
+        :use(THREADS), depth(depth ? depth : 1), threads(threads ? threads : 1),
+         job(0), round(0), active(0), stopping(false) {
+#ifdef __linux__
+        if (b!=THREADS) {
+            try {
+                ring.reset(new UringQueue(this->depth));
+                use = URING;
+            } catch (const char *) {
+                if (b==URING) throw;
+            }
+        }
+#else
+        if (b==URING)
+            throw "io_uring is not available.";
+#endif
+    }
+
+    ~ArrayLoader() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (unsigned t=0; t!=pool.size(); t++)
+            pool[t].join();
+    }
+
+    // 实际使用的方式，URING或THREADS
+    Backend backend() const {return use;}
+
+    // 把文件读入a(a的大小变为文件中完整元素的个数)。每读完chunk个元素，
+    // 就在调用线程中调用f(begin, end)，[begin, end)是这一块的下标范围
+    template<typename T, typename F>
+    void load(const char *path, Array<T> &a, unsigned chunk, F f) {
+        File file(path);
+        struct stat st;
+        if (fstat(file.fd, &st)<0)
+            throw "cannot stat file.";
+        const unsigned long long elems = (unsigned long long)st.st_size / sizeof(T);
+        if (elems > UINT_MAX)
+            throw "file is too large for an Array.";
+        const unsigned n = unsigned(elems);
+        a.resize(n);
+        if (n==0) return;
+        if (chunk==0) chunk = n;
+        Job job;
+        job.fd = file.fd;
+        job.base = reinterpret_cast<char *>(&a[0]);
+        job.bytes = std::size_t(n)*sizeof(T);
+        job.chunk = std::size_t(chunk)*sizeof(T);
+        job.chunks = (n + chunk - 1) / chunk;
+        auto done = [&](unsigned k) {
+            unsigned begin = k*chunk;
+            f(begin, n-begin<chunk ? n : begin+chunk);
+        };
+#ifdef __linux__
+        if (use==URING) {
+            load_uring(job, done);
+            return;
+        }
+#endif
+        load_threads(job, done);
+    }
+
+    // 不需要逐块处理时，等全部读完再返回
+    template<typename T>
+    void load(const char *path, Array<T> &a) {
+        load(path, a, 0, [](unsigned, unsigned) {});
+    }
+
+private:
+    ArrayLoader(const ArrayLoader &);
+    ArrayLoader &operator=(const ArrayLoader &);
+
+    enum { MAX_READ = 1 << 30 };    // 一个读请求的最大字节数
+
+    struct File{
+        explicit File(const char *path):fd(open(path, O_RDONLY)) {
+            if (fd<0)
+                throw "cannot open file.";
+        }
+        ~File() {close(fd);}
+        int fd;
+    };
+
+    struct Job{
+        int fd;
+        char *base;
+        std::size_t bytes, chunk;
+        unsigned chunks;
+
+        std::size_t begin(unsigned k) const {return std::size_t(k)*chunk;}
+        std::size_t size(unsigned k) const {
+            return bytes-begin(k)<chunk ? bytes-begin(k) : chunk;
+        }
+    };
+
+#ifdef __linux__
+    // 保持depth个请求在进行中；收到完成后先补充新的请求，再调用回调，
+    // 这样回调计算的时候内核仍在读后面的块。
+    // 出错时要先等进行中的请求全部完成，内核不能在抛出异常后还写a的缓冲区
+    template<typename F>
+    void load_uring(const Job &job, F done) {
+        std::vector<std::size_t> got(job.chunks, 0);
+        std::vector<unsigned> ready;
+        unsigned next = 0, inflight = 0, finished = 0;
+        const char *error = 0;
+        while (finished!=job.chunks && !error) {
+            ready.clear();
+            while (inflight<depth && next<job.chunks)
+                issue(job, next++, got, inflight);
+            ring->submit(1);
+            unsigned long long tag;
+            int res;
+            while (ring->complete(tag, res)) {
+                unsigned k = unsigned(tag);
+                inflight--;
+                if (res<=0) {
+                    error = res<0 ? "read failed." : "unexpected end of file.";
+                    continue;
+                }
+                got[k] += unsigned(res);
+                if (error) continue;
+                if (got[k]<job.size(k))
+                    issue(job, k, got, inflight);   // 读了一部分，接着读剩下的
+                else
+                    ready.push_back(k);
+            }
+            if (error) break;
+            while (inflight<depth && next<job.chunks)
+                issue(job, next++, got, inflight);
+            ring->submit(0);
+            try {
+                for (unsigned i=0; i!=ready.size(); i++, finished++)
+                    done(ready[i]);
+            } catch (...) {
+                drain(inflight);
+                throw;
+            }
+        }
+        drain(inflight);
+        if (error)
+            throw error;
+    }
+
+    void drain(unsigned inflight) {
+        unsigned long long tag;
+        int res;
+        while (inflight) {
+            ring->submit(1);
+            while (ring->complete(tag, res))
+                inflight--;
+        }
+    }
+
+    void issue(const Job &job, unsigned k, const std::vector<std::size_t> &got, unsigned &inflight) {
+        std::size_t off = job.begin(k) + got[k], len = job.size(k) - got[k];
+        if (len > MAX_READ)
+            len = MAX_READ;     // 超过的部分当作读了一部分，完成后再读
+        // 完成队列的容量是提交队列的两倍，所以提交队列满时只需要先提交
+        while (!ring->read(job.fd, job.base + off, unsigned(len), off, k))
+            ring->submit(0);
+        inflight++;
+    }
+#endif
+
+    // 读线程：每次load唤醒所有读线程，各自依次领取一块并用pread读完，
+    // 完成的块交给调用线程处理；领不到新的块时回去等下一次load
+    void work() {
+        unsigned seen = 0;
+        std::unique_lock<std::mutex> lock(m);
+        for (;;) {
+            wake.wait(lock, [&]{ return stopping || round!=seen; });
+            if (stopping) return;
+            seen = round;
+            const Job &j = *job;
+            lock.unlock();
+            for (unsigned k; !failed && (k = next++) < j.chunks; ) {
+                std::size_t got = 0, size = j.size(k);
+                while (got<size) {
+                    ssize_t r = pread(j.fd, j.base + j.begin(k) + got, size-got,
+                                      off_t(j.begin(k) + got));
+                    if (r<0 && errno==EINTR) continue;
+                    if (r<=0) {
+                        failed = true;
+                        break;
+                    }
+                    got += std::size_t(r);
+                }
+                if (failed) break;
+                std::lock_guard<std::mutex> g(m);
+                done_chunks.push_back(k);
+                arrived.notify_one();
+            }
+            lock.lock();
+            active--;
+            arrived.notify_one();
+        }
+    }
+
+    // 所有读线程都处理完这次load之后才能返回：它们还在写a的缓冲区
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(m);
+        arrived.wait(lock, [&]{ return active==0; });
+        job = 0;
+    }
+
+    template<typename F>
+    void load_threads(const Job &j, F done) {
+        while (pool.size()<threads)
+            pool.push_back(std::thread(&ArrayLoader::work, this));
+        {
+            std::lock_guard<std::mutex> lock(m);
+            job = &j;
+            next = 0;
+            failed = false;
+            done_chunks.clear();
+            active = unsigned(pool.size());
+            round++;
+        }
+        wake.notify_all();
+
+        const char *error = 0;
+        for (unsigned finished=0; finished!=j.chunks && !error; ) {
+            unsigned k;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                arrived.wait(lock, [&]{ return !done_chunks.empty() || active==0; });
+                if (done_chunks.empty()) {
+                    error = "read failed.";
+                    break;
+                }
+                k = done_chunks.front();
+                done_chunks.pop_front();
+            }
+            try {
+                done(k);
+            } catch (...) {
+                failed = true;
+                wait_idle();
+                throw;
+            }
+            finished++;
+        }
+        wait_idle();
+        if (error || failed)
+            throw error ? error : "read failed.";
+    }
+
+    Backend use;
+    unsigned depth, threads;
+#ifdef __linux__
+    std::unique_ptr<UringQueue> ring;
+#endif
+
+    // 读线程与它们共享的状态，job、round、active、done_chunks与stopping由m保护
+    std::vector<std::thread> pool;
+    std::mutex m;
+    std::condition_variable wake, arrived;
+    const Job *job;
+    unsigned round, active;
+    bool stopping;
+    std::atomic<unsigned> next;
+    std::atomic<bool> failed;
+    std::deque<unsigned> done_chunks;   // 读完、还没有交给回调的块
+};
+
+#endif
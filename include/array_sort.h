@@ -0,0 +1,295 @@
+#ifndef ARRAY_SORT_H
+#define ARRAY_SORT_H
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "array.h"
+
+// Array的排序
+// Pointer不是随机访问迭代器，std::sort不能直接用在Array上。这里的排序直接操作元素缓冲区：
+//   radix_sort     对整数、浮点数或由key从记录中取出的这类键做LSD基数排序(稳定)
+//   merge_sort     对任意比较函数做归并排序(稳定)
+// 两者都把数组分给threads个线程；需要的辅助缓冲区由SortScratch提供，
+// 不指定时使用调用线程自己的SortScratch，同一线程多次排序时不会反复分配。
+
+// 排序用的辅助缓冲区，只在需要更大的空间时重新分配
+template<typename T>
+class SortScratch{
+public:
+    SortScratch():data(0), cap(0) {}
+    ~SortScratch() {delete [] data;}
+
+    T *get(unsigned n) {
+        if (n>cap) {
+            T *nd = new T[n];
+            delete [] data;
+            data = nd;
+            cap = n;
+        }
+        return data;
+    }
+    unsigned capacity() const {return cap;}
+
+    // 调用线程默认使用的缓冲区
+    static SortScratch &local() {
+        static thread_local SortScratch s;
+        return s;
+    }
+
+private:
+    SortScratch(const SortScratch &);
+    SortScratch &operator=(const SortScratch &);
+
+    T *data;
+    unsigned cap;
+};
+
+namespace sort_detail {
+
+enum { MIN_PER_THREAD = 1 << 15, INSERTION = 32 };
+
+// 实际使用的线程数：元素太少时不值得开线程
+inline unsigned threads_for(unsigned n, unsigned threads) {
+    if (threads==0)
+        threads = std::thread::hardware_concurrency();
+    if (threads==0)
+        threads = 1;
+    unsigned most = n/MIN_PER_THREAD;
+    if (threads>most)
+        threads = most ? most : 1;
+    return threads;
+}
+
+// 在p个线程中调用f(0)...f(p-1)，f(0)在调用线程中执行
+template<typename F>
+void parallel(unsigned p, F f) {
+    std::vector<std::thread> ts;
+    for (unsigned t=1; t<p; t++)
+        ts.push_back(std::thread(f, t));
+    f(0);
+    for (unsigned t=0; t!=ts.size(); t++)
+        ts[t].join();
+}
+
+// 第t部分的起点
+inline unsigned part(unsigned n, unsigned p, unsigned t) {
+    return unsigned((unsigned long long)n*t/p);
+}
+
+// 把键变换成无符号整数，使无符号整数的顺序就是键的顺序
+template<typename K, typename Enable=void>
+struct RadixKey;
+
+template<typename K>
+struct RadixKey<K, typename std::enable_if<std::is_integral<K>::value>::type> {
+    typedef typename std::make_unsigned<K>::type type;
+    static type encode(K k) {
+        type u = type(k);
+        if (std::is_signed<K>::value)
+            u ^= type(1) << (sizeof(K)*8-1);    // 负数排在前面
+        return u;
+    }
+};
+
+template<typename K>
+struct RadixKey<K, typename std::enable_if<std::is_floating_point<K>::value>::type> {
+    typedef typename std::conditional<sizeof(K)==4, unsigned, unsigned long long>::type type;
+    static type encode(K k) {
+        type u;
+        std::memcpy(&u, &k, sizeof u);
+        const type sign = type(1) << (sizeof(K)*8-1);
+        return u & sign ? ~u : u | sign;        // 负数全部取反，正数只翻转符号位
+    }
+};
+
+struct Identity {
+    template<typename T>
+    const T &operator()(const T &v) const {return v;}
+};
+
+template<typename T, typename K>
+void radix_sort(T *a, unsigned n, K key, unsigned threads, SortScratch<T> &scratch) {
+    typedef typename std::decay<decltype(key(*a))>::type Key;
+    typedef RadixKey<Key> RK;
+    static_assert(std::is_trivially_copyable<T>::value, "radix_sort moves elements with plain copies");
+    if (n<2) return;
+    const unsigned p = threads_for(n, threads);
+    T *src = a, *dst = scratch.get(n);
+    std::vector<unsigned> count(p*256);
+
+    for (unsigned shift=0; shift<sizeof(typename RK::type)*8; shift+=8) {
+        std::fill(count.begin(), count.end(), 0u);
+        parallel(p, [&](unsigned t) {
+            unsigned *c = &count[t*256];
+            for (unsigned i=part(n, p, t), e=part(n, p, t+1); i!=e; i++)
+                c[(RK::encode(key(src[i])) >> shift) & 255]++;
+        });
+        // 所有键在这一位上都相同时跳过这一趟
+        bool skip = false;
+        for (unsigned d=0, total; d!=256 && !skip; d++) {
+            total = 0;
+            for (unsigned t=0; t!=p; t++)
+                total += count[t*256+d];
+            skip = total==n;
+        }
+        if (skip) continue;
+        // 每个线程每个数字的起始位置：先按数字，再按线程，保证稳定
+        unsigned running = 0;
+        for (unsigned d=0; d!=256; d++)
+            for (unsigned t=0; t!=p; t++) {
+                unsigned c = count[t*256+d];
+                count[t*256+d] = running;
+                running += c;
+            }
+        parallel(p, [&](unsigned t) {
+            unsigned *off = &count[t*256];
+            for (unsigned i=part(n, p, t), e=part(n, p, t+1); i!=e; i++)
+                dst[off[(RK::encode(key(src[i])) >> shift) & 255]++] = src[i];
+        });
+        std::swap(src, dst);
+    }
+    if (src!=a)
+        std::memcpy(a, src, std::size_t(n)*sizeof(T));
+}
+
+// 把[a, a+m)与[b, b+k)稳定的合并到out，相等时a中的元素在前
+template<typename T, typename C>
+void merge(const T *a, unsigned m, const T *b, unsigned k, T *out, C less) {
+    unsigned i = 0, j = 0;
+    while (i!=m && j!=k)
+        *out++ = less(b[j], a[i]) ? b[j++] : a[i++];
+    while (i!=m) *out++ = a[i++];
+    while (j!=k) *out++ = b[j++];
+}
+
+// 合并结果的前r个元素中有几个来自a
+template<typename T, typename C>
+unsigned corank(unsigned r, const T *a, unsigned m, const T *b, unsigned k, C less) {
+    unsigned lo = r>k ? r-k : 0, hi = r<m ? r : m;
+    while (lo<hi) {
+        unsigned i = lo + (hi-lo)/2, j = r-i;
+        if (j>0 && !less(b[j-1], a[i]))
+            lo = i+1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+// 用p个线程合并：每个线程负责输出中的一段，用corank找到两个输入中对应的位置
+template<typename T, typename C>
+void parallel_merge(const T *a, unsigned m, const T *b, unsigned k, T *out, C less, unsigned p) {
+    const unsigned n = m+k;
+    parallel(p, [&](unsigned t) {
+        unsigned r0 = part(n, p, t), r1 = part(n, p, t+1);
+        unsigned i0 = corank(r0, a, m, b, k, less), i1 = corank(r1, a, m, b, k, less);
+        merge(a+i0, i1-i0, b+(r0-i0), (r1-i1)-(r0-i0), out+r0, less);
+    });
+}
+
+// 单线程的自底向上归并排序，结果留在a中
+template<typename T, typename C>
+void merge_sort(T *a, T *tmp, unsigned n, C less) {
+    for (unsigned s=0; s<n; s+=INSERTION) {
+        unsigned e = s+INSERTION<n ? s+INSERTION : n;
+        for (unsigned i=s+1; i<e; i++) {
+            T v = a[i];
+            unsigned j = i;
+            for (; j>s && less(v, a[j-1]); j--)
+                a[j] = a[j-1];
+            a[j] = v;
+        }
+    }
+    T *src = a, *dst = tmp;
+    for (unsigned w=INSERTION; w<n; w*=2) {
+        for (unsigned s=0; s<n; s+=2*w) {
+            unsigned mid = s+w<n ? s+w : n, e = s+2*w<n ? s+2*w : n;
+            merge(src+s, mid-s, src+mid, e-mid, dst+s, less);
+        }
+        std::swap(src, dst);
+    }
+    if (src!=a)
+        for (unsigned i=0; i!=n; i++)
+            a[i] = src[i];
+}
+
+template<typename T, typename C>
+void merge_sort(T *a, unsigned n, C less, unsigned threads, SortScratch<T> &scratch) {
+    if (n<2) return;
+    const unsigned p = threads_for(n, threads);
+    T *tmp = scratch.get(n);
+    // 每个线程先排好自己的一段
+    parallel(p, [&](unsigned t) {
+        unsigned s = part(n, p, t), e = part(n, p, t+1);
+        merge_sort(a+s, tmp+s, e-s, less);
+    });
+    // 再逐轮两两合并，每次合并都用上所有线程
+    std::vector<unsigned> runs;
+    for (unsigned t=0; t<=p; t++)
+        runs.push_back(part(n, p, t));
+    T *src = a, *dst = tmp;
+    while (runs.size()>2) {
+        std::vector<unsigned> next;
+        unsigned r = 0;
+        for (; r+2<runs.size(); r+=2) {
+            parallel_merge(src+runs[r], runs[r+1]-runs[r], src+runs[r+1], runs[r+2]-runs[r+1],
+                           dst+runs[r], less, p);
+            next.push_back(runs[r]);
+        }
+        if (r+1<runs.size()) {          // 落单的一段原样复制
+            for (unsigned i=runs[r]; i!=runs[r+1]; i++)
+                dst[i] = src[i];
+            next.push_back(runs[r]);
+        }
+        next.push_back(n);
+        runs.swap(next);
+        std::swap(src, dst);
+    }
+    if (src!=a)
+        parallel(p, [&](unsigned t) {
+            for (unsigned i=part(n, p, t), e=part(n, p, t+1); i!=e; i++)
+                a[i] = src[i];
+        });
+}
+
+struct Less {
+    template<typename T>
+    bool operator()(const T &a, const T &b) const {return a<b;}
+};
+
+}
+
+// 按元素本身的值做基数排序；T须是整数或浮点数
+template<typename T>
+void radix_sort(Array<T> &a, unsigned threads=0, SortScratch<T> &scratch=SortScratch<T>::local())
+{
+    if (a.size())
+        sort_detail::radix_sort(&a[0], a.size(), sort_detail::Identity(), threads, scratch);
+}
+
+// 按key(元素)做基数排序，key返回整数或浮点数
+template<typename T, typename K>
+void radix_sort_by(Array<T> &a, K key, unsigned threads=0, SortScratch<T> &scratch=SortScratch<T>::local())
+{
+    if (a.size())
+        sort_detail::radix_sort(&a[0], a.size(), key, threads, scratch);
+}
+
+template<typename T, typename C>
+void merge_sort(Array<T> &a, C less, unsigned threads=0, SortScratch<T> &scratch=SortScratch<T>::local())
+{
+    if (a.size())
+        sort_detail::merge_sort(&a[0], a.size(), less, threads, scratch);
+}
+
+template<typename T>
+void merge_sort(Array<T> &a)
+{
+    merge_sort(a, sort_detail::Less());
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef FIXED_ARRAY_H
+#define FIXED_ARRAY_H
+
+#include <cassert>
+#include "array.h"
+
+// 元素个数在编译时确定的数组
+// Array<T>总要在堆上分配ArrayData，带着引用计数，每次下标操作都要检查边界。
+// Array<T, N>把N个元素直接保存在对象内部，没有分配也没有引用计数；
+// 构造、下标以及下面的算法都是constexpr的，查找表可以在编译时建好：
+//     constexpr Array<unsigned, 16> squares = generate<unsigned, 16>(square);
+// 常量表达式中越界的下标是编译错误；at<I>()在任何情况下都在编译时检查。
+// 与std::array一样，运行时operator[]不检查边界(只有assert)，需要检查时用at(i)。
+// 元素不会移动，所以不需要Pointer：begin()/end()返回的内置指针支持Pointer的全部操作。
+template<typename T, unsigned N>
+class Array{
+    static_assert(N!=DYNAMIC_EXTENT, "DYNAMIC_EXTENT is reserved for Array<T>");
+public:
+    constexpr Array():elems{} {}
+    // 按顺序初始化前几个元素，其余的为T()
+    template<typename... U>
+    constexpr explicit Array(T first, U... rest):elems{first, T(rest)...} {
+        static_assert(sizeof...(U)<N, "too many Array initializers");
+    }
+
+    static constexpr unsigned size() {return N;}
+
+    constexpr const T& operator[](unsigned i) const {
+        assert(i<N);
+        return elems[i];
+    }
+    constexpr T& operator[](unsigned i) {
+        assert(i<N);
+        return elems[i];
+    }
+
+    constexpr const T& at(unsigned i) const {
+        return i<N ? elems[i] : throw "Array subscript out of range.";
+    }
+    constexpr T& at(unsigned i) {
+        return i<N ? elems[i] : throw "Array subscript out of range.";
+    }
+
+    template<unsigned I>
+    constexpr const T& at() const {
+        static_assert(I<N, "Array subscript out of range");
+        return elems[I];
+    }
+    template<unsigned I>
+    constexpr T& at() {
+        static_assert(I<N, "Array subscript out of range");
+        return elems[I];
+    }
+
+    constexpr T *begin() {return elems;}
+    constexpr T *end() {return elems + N;}
+    constexpr const T *begin() const {return elems;}
+    constexpr const T *end() const {return elems + N;}
+
+    // 与Array<T>互相转换
+    explicit Array(const Array<T> &a):elems{} {
+        if (a.size()!=N)
+            throw "Array size mismatch.";
+        for (unsigned i=0; i!=N; i++)
+            elems[i] = a[i];
+    }
+    Array<T> dynamic() const {
+        Array<T> a(N);
+        for (unsigned i=0; i!=N; i++)
+            a[i] = elems[i];
+        return a;
+    }
+
+private:
+    T elems[N ? N : 1];
+};
+
+template<typename T, unsigned N>
+constexpr bool operator==(const Array<T, N> &lhs, const Array<T, N> &rhs) {
+    for (unsigned i=0; i!=N; i++)
+        if (!(lhs[i]==rhs[i]))
+            return false;
+    return true;
+}
+template<typename T, unsigned N>
+constexpr bool operator!=(const Array<T, N> &lhs, const Array<T, N> &rhs) {
+    return !(lhs == rhs);
+}
+
+// 编译时可用的算法。C++14的lambda不是constexpr的，
+// 在常量表达式中f须是constexpr函数，或operator()为constexpr的函数对象
+
+// a[i] = f(i)
+template<typename T, unsigned N, typename F>
+constexpr Array<T, N> generate(F f) {
+    Array<T, N> a;
+    for (unsigned i=0; i!=N; i++)
+        a[i] = f(i);
+    return a;
+}
+
+template<typename T, unsigned N>
+constexpr void fill(Array<T, N> &a, const T &v) {
+    for (unsigned i=0; i!=N; i++)
+        a[i] = v;
+}
+
+// f(...f(f(init, a[0]), a[1])..., a[N-1])
+template<typename T, unsigned N, typename R, typename F>
+constexpr R fold(const Array<T, N> &a, R init, F f) {
+    for (unsigned i=0; i!=N; i++)
+        init = f(init, a[i]);
+    return init;
+}
+
+// 第一个等于v的元素的下标，没有时返回N
+template<typename T, unsigned N>
+constexpr unsigned find(const Array<T, N> &a, const T &v) {
+    unsigned i = 0;
+    while (i!=N && !(a[i]==v))
+        i++;
+    return i;
+}
+
+// 插入排序：N很小时比快速排序更快，而且可以在编译时进行
+template<typename T, unsigned N>
+constexpr Array<T, N> sorted(Array<T, N> a) {
+    for (unsigned i=1; i<N; i++) {
+        T v = a[i];
+        unsigned j = i;
+        for (; j>0 && v<a[j-1]; j--)
+            a[j] = a[j-1];
+        a[j] = v;
+    }
+    return a;
+}
+
+#endif
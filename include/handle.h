@@ -0,0 +1,75 @@
+#ifndef HANDLE_H
+#define HANDLE_H
+
+#include "surrogate.h"
+#include "instrument.h"
+
+// 句柄类
+// 与Surrogate不同，句柄间的拷贝和赋值共享同一个被代理对象，只增加引用计数。
+// 引用计数放在单独分配的int中(不需要修改Super继承树)。
+// 只有通过非const句柄修改对象，且对象被多个句柄共享时，才复制对象(写时复制)。
+class Handle{
+public:
+        Handle():p(0), u(0) {}   
+        Handle(const Super&s):p(s.clone()), u(new int(1)) {}
+        Handle(const Handle&h):p(h.p), u(h.u) {retain();}
+        Handle &operator=(const Handle &h){
+                h.retain();     // 先增加h的计数，自赋值时也是安全的
+                release();
+                p = h.p;
+                u = h.u;
+                return *this;
+        }
+        ~Handle(){release();}
+
+        // 只读访问，不会复制对象
+        const Super * operator->() const {return p;}
+        const Super & operator*() const {return *p;}
+        const Super *get() const {return p;}
+
+        // 可写访问，对象被共享时先复制一份
+        Super * operator->() {detach(); return p;}
+        Super & operator*() {detach(); return *p;}
+        Super *get() {detach(); return p;}
+
+        void f() {detach(); p->f();}
+
+        // 共享被代理对象的句柄个数，空句柄为0
+        int use_count() const {return u?*u:0;}
+        bool unique() const {return use_count()==1;}
+
+private:
+        void retain() const {
+                if (u) {
+                        ++*u;
+                        INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+                }
+        }
+        void release() {
+                if (u && --*u==0) {
+                        delete p;
+                        delete u;
+                }
+        }
+        void detach() {
+                if (u && *u!=1) {
+                        // 先完成可能抛出异常的复制与分配，再修改共享的计数
+                        Super *np = p->clone();
+                        int *nu;
+                        try {
+                                nu = new int(1);
+                        } catch (...) {
+                                delete np;
+                                throw;
+                        }
+                        --*u;
+                        p = np;
+                        u = nu;
+                }
+        }
+
+        Super *p;
+        int *u;
+};
+
+#endif
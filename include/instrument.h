@@ -0,0 +1,96 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <atomic>
+#include <string>
+#include <sstream>
+
+// 计数器：统计Surrogate、Array、Seq执行的克隆、复制、引用计数等操作的次数。
+// 只有定义了RUMINATIONS_INSTRUMENT时才计数；否则INSTRUMENT_COUNT什么都不做，
+// 其参数也不会被求值，snapshot()总是返回全0。
+namespace instrument {
+
+enum Counter {
+    SUPER_CLONE,          // Super::clone() 的调用次数
+    ARRAY_RESIZE,         // ArrayData::resize 真正重新分配的次数
+    ARRAY_COPY,           // ArrayData::copy 复制的元素个数
+    ARRAY_COPY_BYTES,     // ArrayData::copy 复制的字节数
+    REFCOUNT_INC,         // ArrayData::used 与 SeqItem::use 的增加次数
+    SEQITEM_ALLOC,        // SeqItem 的分配次数
+    COUNTERS
+};
+
+inline const char *name(Counter c) {
+    static const char *const names[COUNTERS] = {
+        "super_clone",
+        "array_resize",
+        "array_copy",
+        "array_copy_bytes",
+        "refcount_inc",
+        "seqitem_alloc",
+    };
+    return names[c];
+}
+
+#ifdef RUMINATIONS_INSTRUMENT
+const bool enabled = true;
+#else
+const bool enabled = false;
+#endif
+
+// 某一时刻所有计数器的值
+struct Snapshot {
+    unsigned long long value[COUNTERS];
+
+    unsigned long long operator[](Counter c) const {
+        return value[c];
+    }
+
+    // 两个快照之差，用于统计某段代码的操作次数
+    Snapshot operator-(const Snapshot &s) const {
+        Snapshot d;
+        for (int i=0; i!=COUNTERS; i++)
+            d.value[i] = value[i] - s.value[i];
+        return d;
+    }
+
+    std::string to_json() const {
+        std::ostringstream os;
+        os << "{\"enabled\": " << (enabled ? "true" : "false");
+        for (int i=0; i!=COUNTERS; i++)
+            os << ", \"" << name(Counter(i)) << "\": " << value[i];
+        os << "}";
+        return os.str();
+    }
+};
+
+inline std::atomic<unsigned long long> *counters() {
+    static std::atomic<unsigned long long> c[COUNTERS];
+    return c;
+}
+
+inline void add(Counter c, unsigned long long n) {
+    counters()[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+inline Snapshot snapshot() {
+    Snapshot s;
+    for (int i=0; i!=COUNTERS; i++)
+        s.value[i] = counters()[i].load(std::memory_order_relaxed);
+    return s;
+}
+
+inline void reset() {
+    for (int i=0; i!=COUNTERS; i++)
+        counters()[i].store(0, std::memory_order_relaxed);
+}
+
+}
+
+#ifdef RUMINATIONS_INSTRUMENT
+#define INSTRUMENT_COUNT(c, n) ::instrument::add(::instrument::c, (n))
+#else
+#define INSTRUMENT_COUNT(c, n) ((void)0)
+#endif
+
+#endif
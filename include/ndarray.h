@@ -0,0 +1,282 @@
+#ifndef NDARRAY_H
+#define NDARRAY_H
+
+#include <type_traits>
+#include "array.h"
+
+// 多维数组
+// Array<Array<T> > 的每一行都是一次单独的分配，行与行之间在内存中并不相邻。
+// NDArray把所有元素放在一个ArrayData中，用形状(shape)和步长(stride)把多维下标映射到一维下标。
+// NDView是不拥有数据的视图，切片、转置等操作都只改变视图的形状和步长，不复制元素。
+
+enum Layout { ROW_MAJOR, COL_MAJOR };
+
+// 参数是否全是整数，用来区分NDArray的下标/形状参数与拷贝构造
+template<typename... S>
+struct all_integral;
+template<>
+struct all_integral<> {
+    static const bool value = true;
+};
+template<typename S, typename... R>
+struct all_integral<S, R...> {
+    static const bool value = std::is_integral<S>::value && all_integral<R...>::value;
+};
+
+template<typename T, unsigned N>
+class NDView{
+    template<typename U, unsigned M> friend class NDView;
+public:
+    NDView():base(0) {
+        for (unsigned k=0; k!=N; k++) {
+            shp[k] = 0;
+            str[k] = 0;
+        }
+    }
+    NDView(T *b, const unsigned *shape, const long *stride):base(b) {
+        for (unsigned k=0; k!=N; k++) {
+            shp[k] = shape[k];
+            str[k] = stride[k];
+        }
+    }
+    // NDView<T,N> 可以转换为 NDView<const T,N>，反之不行
+    template<typename U>
+    NDView(const NDView<U, N> &v):base(v.base) {
+        for (unsigned k=0; k!=N; k++) {
+            shp[k] = v.shp[k];
+            str[k] = v.str[k];
+        }
+    }
+
+    unsigned shape(unsigned k) const {return shp[k];}
+    long stride(unsigned k) const {return str[k];}
+    T *data() const {return base;}
+
+    unsigned size() const {
+        unsigned n = 1;
+        for (unsigned k=0; k!=N; k++)
+            n *= shp[k];
+        return n;
+    }
+
+    template<typename... I>
+    T& operator()(I... i) const {
+        static_assert(sizeof...(I)==N, "wrong number of NDView subscripts");
+        const unsigned idx[N] = {unsigned(i)...};
+        return base[offset(idx)];
+    }
+
+    // 第k维只取[begin, end)
+    NDView slice(unsigned k, unsigned begin, unsigned end) const {
+        if (k>=N || begin>end || end>shp[k])
+            throw "NDView slice out of range.";
+        NDView v(*this);
+        v.base += begin*str[k];
+        v.shp[k] = end-begin;
+        return v;
+    }
+
+    // 固定第k维的下标为i，得到低一维的视图，例如二维数组的一行或一列
+    NDView<T, N-1> fix(unsigned k, unsigned i) const {
+        static_assert(N>1, "cannot fix the only dimension of an NDView");
+        if (k>=N || i>=shp[k])
+            throw "NDView subscript out of range.";
+        unsigned s[N-1];
+        long st[N-1];
+        for (unsigned d=0, j=0; d!=N; d++) {
+            if (d==k) continue;
+            s[j] = shp[d];
+            st[j++] = str[d];
+        }
+        return NDView<T, N-1>(base + i*str[k], s, st);
+    }
+
+    // 逆序所有的维度，二维时就是转置
+    NDView transposed() const {
+        NDView v(*this);
+        for (unsigned k=0; k!=N; k++) {
+            v.shp[k] = shp[N-1-k];
+            v.str[k] = str[N-1-k];
+        }
+        return v;
+    }
+
+    // 按内存顺序访问每个元素：步长最小的维度放在最内层循环
+    template<typename F>
+    void for_each(F f) const {
+        if (size()==0) return;
+        unsigned order[N];
+        for (unsigned k=0; k!=N; k++)
+            order[k] = k;
+        for (unsigned a=1; a<N; a++)
+            for (unsigned b=a; b>0 && absl(str[order[b-1]])<absl(str[order[b]]); b--) {
+                unsigned t = order[b];
+                order[b] = order[b-1];
+                order[b-1] = t;
+            }
+
+        const unsigned inner = order[N-1];
+        const unsigned n = shp[inner];
+        const long s = str[inner];
+        unsigned idx[N] = {0};
+        for (;;) {
+            T *p = base + offset_unchecked(idx);
+            for (unsigned i=0; i!=n; i++)
+                f(p[i*s]);
+            // 外层维度像里程表一样进位
+            int d = int(N)-2;
+            for (; d>=0; d--) {
+                unsigned k = order[d];
+                if (++idx[k]<shp[k]) break;
+                idx[k] = 0;
+            }
+            if (d<0) return;
+        }
+    }
+
+private:
+    static long absl(long x) {return x<0?-x:x;}
+
+    long offset_unchecked(const unsigned *idx) const {
+        long off = 0;
+        for (unsigned k=0; k!=N; k++)
+            off += idx[k]*str[k];
+        return off;
+    }
+    long offset(const unsigned *idx) const {
+        for (unsigned k=0; k!=N; k++)
+            if (idx[k]>=shp[k])
+                throw "NDView subscript out of range.";
+        return offset_unchecked(idx);
+    }
+
+    T *base;
+    unsigned shp[N];
+    long str[N];
+};
+
+// 拥有数据的多维数组，元素保存在一个ArrayData中。
+// 与Array一样，拷贝和赋值复制元素。
+template<typename T, unsigned N>
+class NDArray{
+public:
+    template<typename... S,
+             typename = typename std::enable_if<all_integral<S...>::value>::type>
+    explicit NDArray(S... s):lay(ROW_MAJOR) {
+        static_assert(sizeof...(S)==N, "wrong number of NDArray extents");
+        const unsigned shape[N] = {unsigned(s)...};
+        init(shape);
+    }
+    NDArray(const unsigned *shape, Layout l):lay(l) {
+        init(shape);
+    }
+    NDArray(const NDArray &a):pa(new ArrayData<T>(*a.pa)), lay(a.lay) {
+        for (unsigned k=0; k!=N; k++) {
+            shp[k] = a.shp[k];
+            str[k] = a.str[k];
+        }
+    }
+    NDArray &operator=(const NDArray &a) {
+        if (this != &a) {
+            pa->clone(*a.pa, a.pa->size());
+            lay = a.lay;
+            for (unsigned k=0; k!=N; k++) {
+                shp[k] = a.shp[k];
+                str[k] = a.str[k];
+            }
+        }
+        return *this;
+    }
+    ~NDArray() {if(--pa->used==0)delete pa;}
+
+    unsigned shape(unsigned k) const {return shp[k];}
+    unsigned size() const {return pa->size();}
+    Layout layout() const {return lay;}
+
+    NDView<T, N> view() {return NDView<T, N>(pa->data, shp, str);}
+    NDView<const T, N> view() const {return NDView<const T, N>(pa->data, shp, str);}
+
+    template<typename... I>
+    T& operator()(I... i) {return view()(i...);}
+    template<typename... I>
+    const T& operator()(I... i) const {return view()(i...);}
+
+private:
+    void init(const unsigned *shape) {
+        unsigned n = 1;
+        for (unsigned k=0; k!=N; k++) {
+            shp[k] = shape[k];
+            n *= shape[k];
+        }
+        long s = 1;
+        if (lay==ROW_MAJOR) {
+            for (int k=int(N)-1; k>=0; k--) {
+                str[k] = s;
+                s *= shp[k];
+            }
+        } else {
+            for (unsigned k=0; k!=N; k++) {
+                str[k] = s;
+                s *= shp[k];
+            }
+        }
+        pa = new ArrayData<T>(n);
+    }
+
+    ArrayData<T> *pa;
+    Layout lay;
+    unsigned shp[N];
+    long str[N];
+};
+
+// 分块(tile)访问二维视图：每次处理一个BxB的块，块内的元素同时位于缓存中
+template<typename T, typename F>
+void for_each_tile(const NDView<T, 2> &v, unsigned B, F f)
+{
+    if (B==0)
+        throw "for_each_tile with zero tile size.";
+    for (unsigned ib=0; ib<v.shape(0); ib+=B)
+        for (unsigned jb=0; jb<v.shape(1); jb+=B)
+            f(v.slice(0, ib, ib+B<v.shape(0)?ib+B:v.shape(0))
+               .slice(1, jb, jb+B<v.shape(1)?jb+B:v.shape(1)));
+}
+
+// 分块转置：dst(j,i) = src(i,j)
+// 逐行读src时按列写dst，每写一个元素都跨越一行。分块后先把一块连续的读入缓冲区，
+// 再从缓冲区连续的写到dst，读写都按行进行；当行的长度是2的幂时，
+// 同一列的元素会映射到同一个缓存组，直接在块内按列访问仍然会不断的互相驱逐。
+template<typename T, typename U>
+void transpose(const NDView<T, 2> &src, const NDView<U, 2> &dst, unsigned B=32)
+{
+    if (src.shape(0)!=dst.shape(1) || src.shape(1)!=dst.shape(0))
+        throw "transpose shape mismatch.";
+    if (B==0)
+        throw "transpose with zero tile size.";
+    const unsigned rows = src.shape(0), cols = src.shape(1);
+    const long ss0 = src.stride(0), ss1 = src.stride(1);
+    const long ds0 = dst.stride(0), ds1 = dst.stride(1);
+    T *s = src.data();
+    U *d = dst.data();
+    Array<U> tile(B*B);
+    U *buf = &tile[0];
+    for (unsigned ib=0; ib<rows; ib+=B) {
+        unsigned ie = ib+B<rows ? ib+B : rows;
+        for (unsigned jb=0; jb<cols; jb+=B) {
+            unsigned je = jb+B<cols ? jb+B : cols;
+            for (unsigned i=ib; i!=ie; i++) {
+                const T *sp = s + i*ss0 + jb*ss1;
+                U *bp = buf + (i-ib)*B;
+                for (unsigned j=jb; j!=je; j++, sp+=ss1)
+                    *bp++ = *sp;
+            }
+            for (unsigned j=jb; j!=je; j++) {
+                U *dp = d + j*ds0 + ib*ds1;
+                const U *bp = buf + (j-jb);
+                for (unsigned i=ib; i!=ie; i++, dp+=ds1, bp+=B)
+                    *dp = *bp;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef PACKED_ARRAY_H
+#define PACKED_ARRAY_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <utility>
+#include "array.h"
+
+// 压缩的整数数组(只读)
+// ArrayData中每个元素都占满sizeof(T)个字节，而很多整数列的值很小，或者是有序的。
+// PackedArray每BLOCK个元素组成一块，块内第i个元素表示为
+//     v[i] = base + i*step + packed[i]
+// 其中packed[i]>=0，按该块所需的最少位数紧密排列。step为0时就是frame-of-reference；
+// 对有序数据取step为块内的平均差值，余下的packed[i]就只是与直线的偏差。
+// 与逐个保存差值(delta)不同，这样仍然可以在O(1)时间内访问任意一个元素。
+// 顺序扫描时按块解码：每种位宽有各自的解码函数，移位量都是常数，编译器可以展开并向量化。
+template<typename T>
+class PackedArray{
+    static_assert(std::is_integral<T>::value && sizeof(T)<=4,
+                  "PackedArray stores integers of at most 32 bits");
+public:
+    enum { BLOCK = 128, GROUP = 32, PAD = 2 };
+
+    PackedArray():n(0), words(PAD, 0) {}
+    PackedArray(const T *v, unsigned count) {encode(v, count);}
+    explicit PackedArray(const Array<T> &a) {
+        std::vector<T> v(a.size());
+        for (unsigned i=0; i!=a.size(); i++)
+            v[i] = a[i];
+        encode(v.data(), a.size());
+    }
+
+    unsigned size() const {return n;}
+    unsigned blocks() const {return unsigned(heads.size());}
+
+    T operator[](unsigned i) const {
+        if (i>=n)
+            throw "PackedArray subscript out of range.";
+        const Block &b = heads[i/BLOCK];
+        const unsigned j = i%BLOCK;
+        const std::uint64_t bit = std::uint64_t(j)*b.width;
+        const std::uint32_t *w = words.data() + b.offset + unsigned(bit>>5);
+        std::uint64_t two;
+        std::memcpy(&two, w, sizeof two);   // 末尾多留了PAD个字，总可以读两个字
+        std::uint64_t packed = (two >> (bit&31)) & mask(b.width);
+        return T(b.base + std::int64_t(j)*b.step + std::int64_t(packed));
+    }
+
+    // 把第k块解码到out中，返回该块的元素个数；out至少要有BLOCK个元素的空间
+    unsigned decode(unsigned k, T *out) const {
+        const Block &b = heads[k];
+        std::uint32_t packed[BLOCK];
+        unpackers()[b.width](words.data() + b.offset, packed);
+        const std::int64_t base = b.base, step = b.step;
+        for (unsigned i=0; i!=BLOCK; i++)
+            out[i] = T(base + std::int64_t(i)*step + packed[i]);
+        return k+1==blocks() ? n - k*BLOCK : unsigned(BLOCK);
+    }
+
+    // 按顺序访问每个元素
+    template<typename F>
+    void for_each(F f) const {
+        T buf[BLOCK];
+        for (unsigned k=0; k!=blocks(); k++) {
+            unsigned c = decode(k, buf);
+            for (unsigned i=0; i!=c; i++)
+                f(buf[i]);
+        }
+    }
+
+    Array<T> unpack() const {
+        Array<T> a(n);
+        T buf[BLOCK];
+        for (unsigned k=0; k!=blocks(); k++) {
+            unsigned c = decode(k, buf);
+            for (unsigned i=0; i!=c; i++)
+                a[k*BLOCK+i] = buf[i];
+        }
+        return a;
+    }
+
+    // 占用的字节数，以及与Array相比的压缩率
+    std::size_t bytes() const {
+        return words.size()*sizeof(std::uint32_t) + heads.size()*sizeof(Block);
+    }
+    double ratio() const {
+        return bytes() ? double(std::size_t(n)*sizeof(T))/bytes() : 0;
+    }
+
+private:
+    struct Block{
+        std::int64_t base;
+        std::int32_t step;
+        std::uint32_t width;
+        std::uint32_t offset;   // 在words中的起始位置
+    };
+
+    static std::uint64_t mask(unsigned width) {
+        return (std::uint64_t(1) << width) - 1;
+    }
+    static unsigned bits(std::uint64_t x) {
+        return x ? 64 - __builtin_clzll(x) : 0;
+    }
+
+    // 以给定的step表示v[0..c)，返回所需的位宽和base
+    static unsigned fit(const T *v, unsigned c, std::int64_t step, std::int64_t &base) {
+        std::int64_t lo = std::int64_t(v[0]), hi = lo;
+        for (unsigned i=1; i<c; i++) {
+            std::int64_t r = std::int64_t(v[i]) - std::int64_t(i)*step;
+            if (r<lo) lo = r;
+            if (r>hi) hi = r;
+        }
+        base = lo;
+        return bits(std::uint64_t(hi-lo));
+    }
+
+    void encode(const T *v, unsigned count) {
+        n = count;
+        heads.clear();
+        words.clear();
+        for (unsigned start=0; start<n; start+=BLOCK) {
+            const unsigned c = n-start<BLOCK ? n-start : unsigned(BLOCK);
+            const T *p = v + start;
+            // 只用step为0时位宽不会超过32；平均差值只在更省空间时才采用
+            Block b;
+            std::int64_t base;
+            b.step = 0;
+            b.width = fit(p, c, 0, b.base);
+            if (c>1) {
+                std::int64_t d = std::int64_t(p[c-1]) - std::int64_t(p[0]), h = (c-1)/2;
+                std::int64_t s = d>=0 ? (d+h)/(c-1) : -((h-d)/(c-1));   // 四舍五入
+                if (s!=0 && s>=INT32_MIN && s<=INT32_MAX) {
+                    unsigned w = fit(p, c, s, base);
+                    if (w<b.width) {
+                        b.width = w;
+                        b.step = std::int32_t(s);
+                        b.base = base;
+                    }
+                }
+            }
+            b.offset = unsigned(words.size());
+            heads.push_back(b);
+            words.resize(words.size() + BLOCK/32*b.width, 0);
+            std::uint32_t *out = words.data() + b.offset;
+            for (unsigned i=0; b.width && i!=c; i++) {
+                std::uint64_t r = std::uint64_t(std::int64_t(p[i]) - std::int64_t(i)*b.step - b.base);
+                std::uint64_t bit = std::uint64_t(i)*b.width;
+                out[bit>>5] |= std::uint32_t(r << (bit&31));
+                if ((bit&31) + b.width > 32)
+                    out[(bit>>5)+1] |= std::uint32_t(r >> (32 - (bit&31)));
+            }
+        }
+        words.resize(words.size() + PAD, 0);
+    }
+
+    // 位宽为W的解码：每GROUP个值正好占W个字，GROUP个值在编译时展开，移位量都是常数。
+    // 每次读入两个字再移位，不需要判断值是否跨越了字的边界(末尾多留的PAD个字保证不会越界)
+    typedef void (*Unpacker)(const std::uint32_t *, std::uint32_t *);
+
+    template<unsigned W, std::size_t J>
+    static std::uint32_t extract(const std::uint32_t *in) {
+        std::uint64_t two;
+        std::memcpy(&two, in + (J*W>>5), sizeof two);
+        return std::uint32_t((two >> (J*W&31)) & mask(W));
+    }
+    template<unsigned W, std::size_t... J>
+    static void unpack(const std::uint32_t *in, std::uint32_t *out, std::index_sequence<J...>) {
+        int expand[] = {0, (out[J] = extract<W, J>(in), 0)...};
+        (void)expand;
+    }
+    template<unsigned W>
+    static void unpack(const std::uint32_t *in, std::uint32_t *out) {
+        for (unsigned g=0; g!=BLOCK/GROUP; g++, in+=W, out+=GROUP)
+            unpack<W>(in, out, std::make_index_sequence<GROUP>());
+    }
+
+    template<std::size_t... W>
+    static const Unpacker *unpackers(std::index_sequence<W...>) {
+        static const Unpacker table[] = {&unpack<unsigned(W)>...};
+        return table;
+    }
+    static const Unpacker *unpackers() {
+        return unpackers(std::make_index_sequence<33>());
+    }
+
+    unsigned n;
+    std::vector<Block> heads;
+    std::vector<std::uint32_t> words;
+};
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef PMAP_H
+#define PMAP_H
+
+#include <functional>
+#include <vector>
+#include "instrument.h"
+
+// 持久化有序映射(persistent map)
+// Seq与PVector都只能按位置访问。PMap是一棵按权重平衡的二叉搜索树(weight-balanced tree)，
+// 查找、插入、删除都是O(log n)的。insert和erase不修改原来的映射，而是返回一个新版本：
+// 只复制从根到被修改节点的那条路径，其余节点在新旧版本间共享，
+// 节点的共享采用与SeqItem一样的引用计数(use)。复制一个PMap只是给根节点加1，
+// 所以保存一个版本(快照)后，可以一边遍历它一边继续修改。
+// 与Seq一样，引用计数不是原子的，共享节点的PMap不能同时被多个线程使用。
+
+template<typename K, typename V, typename Less>
+class PMap;
+template<typename K, typename V, typename Less>
+class PMapCursor;
+
+template<typename K, typename V>
+class PMapNode {
+    template<typename K2, typename V2, typename L> friend class PMap;
+    template<typename K2, typename V2, typename L> friend class PMapCursor;
+
+    PMapNode(const K &k, const V &v, PMapNode *l, PMapNode *r)
+        :use(1), size(1 + (l ? l->size : 0) + (r ? r->size : 0)),
+         left(l), right(r), key(k), value(v) {}
+
+    int use;
+    unsigned size;      // 子树中的节点数，用来保持平衡
+    PMapNode *left, *right;
+    K key;
+    V value;
+};
+
+template<typename K, typename V, typename Less=std::less<K> >
+class PMap {
+    friend class PMapCursor<K, V, Less>;
+    typedef PMapNode<K, V> Node;
+public:
+    PMap():root(0) {}
+    PMap(const PMap &m):root(m.root) {retain(root);}
+    PMap &operator=(const PMap &m) {
+        retain(m.root);
+        release(root);
+        root = m.root;
+        return *this;
+    }
+    ~PMap() {release(root);}
+
+    unsigned size() const {return root ? root->size : 0;}
+    bool empty() const {return root==0;}
+
+    // 没有k时返回空指针
+    const V *find(const K &k) const {
+        for (const Node *n=root; n; ) {
+            if (less(k, n->key)) n = n->left;
+            else if (less(n->key, k)) n = n->right;
+            else return &n->value;
+        }
+        return 0;
+    }
+    bool contains(const K &k) const {return find(k)!=0;}
+    const V &at(const K &k) const {
+        const V *v = find(k);
+        if (!v)
+            throw "PMap key not found.";
+        return *v;
+    }
+    const V &operator[](const K &k) const {return at(k);}
+
+    // 返回加入(或替换)了k的新版本
+    PMap insert(const K &k, const V &v) const {
+        return PMap(insert(root, k, v));
+    }
+    // 返回去掉了k的新版本；没有k时返回与*this共享的副本
+    PMap erase(const K &k) const {
+        if (!contains(k))
+            return *this;
+        return PMap(erase(root, k));
+    }
+
+    // 按键的顺序访问每一对f(key, value)
+    template<typename F>
+    void for_each(F f) const {
+        for_each(root, f);
+    }
+
+    // 两个版本是否共享同一棵树
+    bool same(const PMap &m) const {return root==m.root;}
+
+private:
+    enum { DELTA = 3, GAMMA = 2 };  // Hirai与Yamamoto给出的平衡参数
+
+    explicit PMap(Node *n):root(n) {}   // 接管n的引用
+
+    static bool less(const K &a, const K &b) {return Less()(a, b);}
+
+    static void retain(Node *n) {
+        if (n) {
+            ++n->use;
+            INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+        }
+    }
+    static void release(Node *n) {
+        if (n && --n->use==0) {
+            release(n->left);
+            release(n->right);
+            delete n;
+        }
+    }
+    static unsigned weight(const Node *n) {return (n ? n->size : 0) + 1;}
+
+    // 下面的函数都接管参数l、r的引用，返回一个新的引用
+
+    // 以(k, v)为根、l和r为子树建立节点，必要时旋转一次或两次以恢复平衡
+    static Node *balance(const K &k, const V &v, Node *l, Node *r) {
+        const unsigned wl = weight(l), wr = weight(r);
+        if (wr > DELTA*wl) {
+            Node *rl = r->left, *rr = r->right;
+            Node *n;
+            if (weight(rl) < GAMMA*weight(rr)) {            // 单旋转
+                retain(rl);
+                retain(rr);
+                n = new Node(r->key, r->value, new Node(k, v, l, rl), rr);
+            } else {                                        // 双旋转
+                retain(rl->left);
+                retain(rl->right);
+                retain(rr);
+                n = new Node(rl->key, rl->value, new Node(k, v, l, rl->left),
+                             new Node(r->key, r->value, rl->right, rr));
+            }
+            release(r);
+            return n;
+        }
+        if (wl > DELTA*wr) {
+            Node *ll = l->left, *lr = l->right;
+            Node *n;
+            if (weight(lr) < GAMMA*weight(ll)) {
+                retain(ll);
+                retain(lr);
+                n = new Node(l->key, l->value, ll, new Node(k, v, lr, r));
+            } else {
+                retain(lr->left);
+                retain(lr->right);
+                retain(ll);
+                n = new Node(lr->key, lr->value, new Node(l->key, l->value, ll, lr->left),
+                             new Node(k, v, lr->right, r));
+            }
+            release(l);
+            return n;
+        }
+        return new Node(k, v, l, r);
+    }
+
+    static Node *insert(Node *n, const K &k, const V &v) {
+        if (!n)
+            return new Node(k, v, 0, 0);
+        if (less(k, n->key)) {
+            retain(n->right);
+            return balance(n->key, n->value, insert(n->left, k, v), n->right);
+        }
+        if (less(n->key, k)) {
+            retain(n->left);
+            return balance(n->key, n->value, n->left, insert(n->right, k, v));
+        }
+        retain(n->left);
+        retain(n->right);
+        return new Node(k, v, n->left, n->right);
+    }
+
+    // 调用者保证k存在
+    static Node *erase(Node *n, const K &k) {
+        if (less(k, n->key)) {
+            retain(n->right);
+            return balance(n->key, n->value, erase(n->left, k), n->right);
+        }
+        if (less(n->key, k)) {
+            retain(n->left);
+            return balance(n->key, n->value, n->left, erase(n->right, k));
+        }
+        // 用较重一侧的最大或最小节点代替n
+        Node *l = n->left, *r = n->right;
+        if (!l) {
+            retain(r);
+            return r;
+        }
+        if (!r) {
+            retain(l);
+            return l;
+        }
+        if (l->size > r->size) {
+            const Node *m = l;
+            while (m->right) m = m->right;
+            retain(r);
+            return balance(m->key, m->value, erase_max(l), r);
+        }
+        const Node *m = r;
+        while (m->left) m = m->left;
+        retain(l);
+        return balance(m->key, m->value, l, erase_min(r));
+    }
+    static Node *erase_min(Node *n) {
+        if (!n->left) {
+            retain(n->right);
+            return n->right;
+        }
+        retain(n->right);
+        return balance(n->key, n->value, erase_min(n->left), n->right);
+    }
+    static Node *erase_max(Node *n) {
+        if (!n->right) {
+            retain(n->left);
+            return n->left;
+        }
+        retain(n->left);
+        return balance(n->key, n->value, n->left, erase_max(n->right));
+    }
+
+    template<typename F>
+    static void for_each(const Node *n, F &f) {
+        for (; n; n=n->right) {
+            for_each(n->left, f);
+            f(n->key, n->value);
+        }
+    }
+
+    Node *root;
+};
+
+// 按键的顺序遍历一个版本。游标持有该版本的副本，之后产生的新版本不影响遍历
+template<typename K, typename V, typename Less=std::less<K> >
+class PMapCursor {
+    typedef PMapNode<K, V> Node;
+public:
+    explicit PMapCursor(const PMap<K, V, Less> &m):snapshot(m) {
+        descend(snapshot.root);
+    }
+
+    operator bool() const {return !stack.empty();}
+
+    const K &key() const {
+        if (stack.empty()) throw "key of an exhausted PMapCursor";
+        return stack.back()->key;
+    }
+    const V &value() const {
+        if (stack.empty()) throw "value of an exhausted PMapCursor";
+        return stack.back()->value;
+    }
+
+    PMapCursor &operator++() {
+        if (!stack.empty()) {
+            const Node *n = stack.back();
+            stack.pop_back();
+            descend(n->right);
+        }
+        return *this;
+    }
+
+private:
+    void descend(const Node *n) {
+        for (; n; n=n->left)
+            stack.push_back(n);
+    }
+
+    PMap<K, V, Less> snapshot;
+    std::vector<const Node *> stack;
+};
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 性能剖析：硬件计数器与延迟直方图
+// instrument.h统计的是操作次数，这里统计的是这些操作的代价：
+//   Counters   用Linux的perf_event_open统计一段代码的周期、指令、缓存与分支预测失败次数
+//   Histogram  对数-线性分桶的延迟直方图(与HdrHistogram相同的思路)，相对误差约为1/32
+//   run        把一个操作重复执行ops次，同时收集计数器与每次操作的延迟
+// 容器中常常不允许使用硬件计数器(perf_event_paranoid、seccomp或虚拟机不支持)，
+// 打不开的计数器记为不可用，在JSON中输出为null，延迟直方图仍然照常工作。
+namespace profile {
+
+enum Event {
+    CYCLES,             // CPU周期
+    INSTRUCTIONS,       // 执行的指令数
+    L1D_MISSES,         // L1数据缓存读未命中
+    LLC_MISSES,         // 最后一级缓存未命中
+    BRANCH_MISSES,      // 分支预测失败
+    PAGE_FAULTS,        // 缺页(软件事件，通常总是可用)
+    EVENTS
+};
+
+inline const char *name(Event e) {
+    static const char *const names[EVENTS] = {
+        "cycles",
+        "instructions",
+        "l1d_misses",
+        "llc_misses",
+        "branch_misses",
+        "page_faults",
+    };
+    return names[e];
+}
+
+// 一段代码的计数结果；被复用(multiplex)的计数器已经按实际计数的时间比例放大
+struct Counts {
+    unsigned long long value[EVENTS];
+    bool valid[EVENTS];
+
+    // 每次操作的平均值；ops为0或计数器不可用时输出null
+    std::string to_json(unsigned long long ops=1) const {
+        std::ostringstream os;
+        os << "{";
+        for (int i=0; i!=EVENTS; i++) {
+            os << (i ? ", \"" : "\"") << name(Event(i)) << "\": ";
+            if (valid[i] && ops)
+                os << double(value[i])/ops;
+            else
+                os << "null";
+        }
+        os << "}";
+        return os.str();
+    }
+};
+
+// 只统计调用线程在用户态的事件，所以perf_event_paranoid为2时也可以使用
+class Counters {
+public:
+    Counters() {
+        for (int i=0; i!=EVENTS; i++)
+            fd[i] = open(Event(i));
+    }
+    ~Counters() {
+#ifdef __linux__
+        for (int i=0; i!=EVENTS; i++)
+            if (fd[i]>=0)
+                close(fd[i]);
+#endif
+    }
+
+    bool available(Event e) const {return fd[e]>=0;}
+    // 是否至少有一个硬件计数器可用
+    bool available() const {
+        for (int i=0; i!=PAGE_FAULTS; i++)
+            if (fd[i]>=0)
+                return true;
+        return false;
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int i=0; i!=EVENTS; i++)
+            if (fd[i]>=0) {
+                ioctl(fd[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+    }
+
+    Counts stop() {
+        Counts c;
+        for (int i=0; i!=EVENTS; i++) {
+            c.value[i] = 0;
+            c.valid[i] = false;
+        }
+#ifdef __linux__
+        for (int i=0; i!=EVENTS; i++)
+            if (fd[i]>=0)
+                ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        for (int i=0; i!=EVENTS; i++) {
+            // value, time_enabled, time_running
+            unsigned long long r[3];
+            if (fd[i]<0 || read(fd[i], r, sizeof r)!=sizeof r || r[2]==0)
+                continue;
+            c.value[i] = r[2]<r[1] ? (unsigned long long)(double(r[0])*r[1]/r[2]) : r[0];
+            c.valid[i] = true;
+        }
+#endif
+        return c;
+    }
+
+private:
+    Counters(const Counters &);
+    Counters &operator=(const Counters &);
+
+    static int open(Event e) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (e) {
+        case CYCLES:        attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case INSTRUCTIONS:  attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case LLC_MISSES:    attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case PAGE_FAULTS:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+        default:
+            return -1;
+        }
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)e;
+        return -1;
+#endif
+    }
+
+    int fd[EVENTS];
+};
+
+// 记录非负整数(通常是纳秒)的直方图。小于2*SUB的值精确记录；
+// 更大的值按2的幂分段，每段再均分为SUB个桶，所以相对误差不超过1/SUB；
+// 不小于2^63的值都记在最后一个桶中
+class Histogram {
+public:
+    enum { SUB_BITS = 5, SUB = 1 << SUB_BITS, BUCKETS = (64 - SUB_BITS) * SUB };
+
+    Histogram() {reset();}
+
+    void reset() {
+        std::memset(counts, 0, sizeof counts);
+        total = 0;
+        sum = 0;
+        lo = ~0ull;
+        hi = 0;
+    }
+
+    void record(unsigned long long v, unsigned long long n=1) {
+        counts[bucket(v)] += n;
+        total += n;
+        sum += double(v)*n;
+        if (v<lo) lo = v;
+        if (v>hi) hi = v;
+    }
+
+    void merge(const Histogram &h) {
+        for (unsigned i=0; i!=BUCKETS; i++)
+            counts[i] += h.counts[i];
+        total += h.total;
+        sum += h.sum;
+        if (h.lo<lo) lo = h.lo;
+        if (h.hi>hi) hi = h.hi;
+    }
+
+    unsigned long long count() const {return total;}
+    unsigned long long min() const {return total ? lo : 0;}
+    unsigned long long max() const {return hi;}
+    double mean() const {return total ? sum/total : 0;}
+
+    // 至少有p%的记录不大于返回值；返回值是所在桶的上界，但不超过max()
+    unsigned long long percentile(double p) const {
+        if (total==0)
+            return 0;
+        unsigned long long rank = (unsigned long long)(p/100*total + 0.5);
+        if (rank==0) rank = 1;
+        if (rank>total) rank = total;
+        unsigned long long seen = 0;
+        for (unsigned i=0; i!=BUCKETS; i++) {
+            seen += counts[i];
+            if (seen>=rank) {
+                unsigned long long u = upper(i);
+                return u<hi ? u : hi;
+            }
+        }
+        return hi;
+    }
+
+    std::string to_json() const {
+        std::ostringstream os;
+        os << "{\"count\": " << total << ", \"min\": " << min() << ", \"mean\": " << mean()
+           << ", \"p50\": " << percentile(50) << ", \"p90\": " << percentile(90)
+           << ", \"p99\": " << percentile(99) << ", \"p999\": " << percentile(99.9)
+           << ", \"max\": " << max() << "}";
+        return os.str();
+    }
+
+    static unsigned bucket(unsigned long long v) {
+        if (v < 2*SUB)
+            return unsigned(v);
+        unsigned e = 63 - __builtin_clzll(v) - SUB_BITS;       // v>>e在[SUB, 2*SUB)中
+        if (e+1 >= BUCKETS/SUB)
+            return BUCKETS-1;
+        return (e+1)*SUB + unsigned(v>>e) - SUB;
+    }
+    // 第i个桶中最大的值
+    static unsigned long long upper(unsigned i) {
+        if (i < 2*SUB)
+            return i;
+        if (i >= BUCKETS-1)
+            return ~0ull;
+        unsigned e = i/SUB - 1;
+        unsigned long long m = i%SUB + SUB;
+        return ((m+1) << e) - 1;
+    }
+
+private:
+    unsigned long long counts[BUCKETS];
+    unsigned long long total;
+    double sum;
+    unsigned long long lo, hi;
+};
+
+// 一段被剖析代码的结果
+struct Report {
+    std::string name;
+    unsigned long long ops;
+    unsigned long long ns;      // 总时间
+    Counts counters;            // 整段代码的计数，包括计时本身的开销
+    Histogram latency;          // 每次操作的纳秒数
+
+    std::string to_json() const {
+        std::ostringstream os;
+        os << "{\"name\": \"" << name << "\", \"ops\": " << ops
+           << ", \"ns_per_op\": " << (ops ? double(ns)/ops : 0)
+           << ", \"per_op\": " << counters.to_json(ops)
+           << ", \"latency_ns\": " << latency.to_json() << "}";
+        return os.str();
+    }
+};
+
+// 调用op(i)，i从0到ops-1，每batch次读一次时钟，把这一批的平均时间记为每次操作的延迟。
+// 像operator[]这样只要几纳秒的操作，读时钟的开销比操作本身还大，batch应取几十或更多；
+// batch为1时记录的是每次操作真实的延迟分布。
+template<typename F>
+Report run(const char *name, unsigned long long ops, F op, unsigned batch=1) {
+    typedef std::chrono::steady_clock Clock;
+    Report r;
+    r.name = name;
+    r.ops = ops;
+    if (batch==0) batch = 1;
+    Counters c;
+    c.start();
+    const Clock::time_point begin = Clock::now();
+    Clock::time_point t0 = begin;
+    for (unsigned long long i=0; i<ops; ) {
+        unsigned long long e = ops-i<batch ? ops : i+batch;
+        const unsigned long long n = e-i;
+        for (; i!=e; i++)
+            op(i);
+        const Clock::time_point t1 = Clock::now();
+        const unsigned long long d = std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count();
+        r.latency.record(d/n, n);
+        t0 = t1;
+    }
+    r.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t0-begin).count();
+    r.counters = c.stop();
+    return r;
+}
+
+}
+
+#endif
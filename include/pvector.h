@@ -0,0 +1,296 @@
+#ifndef PVECTOR_H
+#define PVECTOR_H
+
+#include <utility>
+
+// 持久化向量(persistent vector)
+// Seq只能访问头部，按下标访问是O(n)的。PVector是一棵32叉的字典树(trie)，
+// 按下标访问、修改、追加都是O(log32 n)的。每次修改只复制从根到叶子的那条路径，
+// 其余节点在新旧版本间共享，节点的共享采用与SeqItem一样的引用计数(use)。
+// 另外，最后一个叶子节点(tail)单独保存，使push_back在大多数情况下只需复制tail。
+
+template<typename T>
+class PVector;
+template<typename T>
+class TransientPVector;
+template<typename T>
+class PVecBranch;
+template<typename T>
+class PVecLeaf;
+
+// 节点：内部节点保存32个子节点指针，叶子节点保存32个元素
+template<typename T>
+class PVecNode {
+    friend class PVector<T>;
+    friend class TransientPVector<T>;
+    friend class PVecBranch<T>;
+    friend class PVecLeaf<T>;
+
+    enum { BITS = 5, WIDTH = 1 << BITS, MASK = WIDTH - 1 };
+
+    PVecNode():use(1) {}
+
+    int use;
+};
+
+template<typename T>
+class PVecBranch : public PVecNode<T> {
+    friend class PVector<T>;
+    friend class TransientPVector<T>;
+
+    PVecBranch() {
+        for (int i=0; i!=PVecNode<T>::WIDTH; i++)
+            kids[i] = 0;
+    }
+    // 复制节点时，子节点被新旧两个节点共享
+    PVecBranch(const PVecBranch &b) {
+        for (int i=0; i!=PVecNode<T>::WIDTH; i++) {
+            kids[i] = b.kids[i];
+            if (kids[i]) ++kids[i]->use;
+        }
+    }
+
+    PVecNode<T> *kids[PVecNode<T>::WIDTH];
+};
+
+template<typename T>
+class PVecLeaf : public PVecNode<T> {
+    friend class PVector<T>;
+    friend class TransientPVector<T>;
+
+    PVecLeaf() {}
+    PVecLeaf(const PVecLeaf &l, unsigned n) {
+        for (unsigned i=0; i!=n; i++)
+            vals[i] = l.vals[i];
+    }
+
+    T vals[PVecNode<T>::WIDTH];
+};
+
+// 持久化向量的公共部分：不可变的快照
+template<typename T>
+class PVector {
+    friend class TransientPVector<T>;
+    typedef PVecNode<T> Node;
+    typedef PVecBranch<T> Branch;
+    typedef PVecLeaf<T> Leaf;
+public:
+    PVector():cnt(0), shift(Node::BITS), root(0), tail(0) {}
+    PVector(const PVector &v):cnt(v.cnt), shift(v.shift), root(v.root), tail(v.tail) {
+        if (root) ++root->use;
+        if (tail) ++tail->use;
+    }
+    // 先由副本取得v的节点，再交换；旧的节点随副本一起释放
+    PVector &operator=(const PVector &v) {
+        PVector copy(v);
+        swap(copy);
+        return *this;
+    }
+    void swap(PVector &v) {
+        std::swap(cnt, v.cnt);
+        std::swap(shift, v.shift);
+        std::swap(root, v.root);
+        std::swap(tail, v.tail);
+    }
+    ~PVector() {
+        destroy();
+    }
+
+    unsigned size() const {
+        return cnt;
+    }
+
+    const T& operator[](unsigned i) const {
+        if (i>=cnt)
+            throw "PVector subscript out of range.";
+        return leaf_for(i)->vals[i & Node::MASK];
+    }
+
+    // 以下操作都不修改*this，而是返回一个新版本
+    PVector push_back(const T &v) const {
+        TransientPVector<T> t(*this);
+        t.push_back(v);
+        return t.take();
+    }
+
+    PVector set(unsigned i, const T &v) const {
+        TransientPVector<T> t(*this);
+        t.set(i, v);
+        return t.take();
+    }
+
+    // 批量修改时使用，见TransientPVector
+    TransientPVector<T> transient() const {
+        return TransientPVector<T>(*this);
+    }
+
+private:
+    // 前32*k个元素保存在树中，剩下的在tail中
+    unsigned tailoff() const {
+        return cnt<Node::WIDTH ? 0 : ((cnt-1) >> Node::BITS) << Node::BITS;
+    }
+
+    const Leaf *leaf_for(unsigned i) const {
+        if (i>=tailoff())
+            return tail;
+        const Node *n = root;
+        for (unsigned level=shift; level>0; level-=Node::BITS)
+            n = static_cast<const Branch *>(n)->kids[(i >> level) & Node::MASK];
+        return static_cast<const Leaf *>(n);
+    }
+
+    // 节点本身不知道自己是内部节点还是叶子，由所在的层次(level)决定
+    static void release(Node *n, unsigned level) {
+        if (!n || --n->use!=0) return;
+        if (level==0) {
+            delete static_cast<Leaf *>(n);
+            return;
+        }
+        Branch *b = static_cast<Branch *>(n);
+        for (int i=0; i!=Node::WIDTH; i++)
+            release(b->kids[i], level-Node::BITS);
+        delete b;
+    }
+
+    void destroy() {
+        release(root, shift);
+        release(tail, 0);
+    }
+
+    unsigned cnt;
+    unsigned shift;
+    Node *root;
+    Leaf *tail;
+};
+
+// 可变的临时版本，用于批量构建。
+// 引用计数为1的节点只被当前版本引用，可以原地修改，不必复制路径；
+// 被其他快照共享的节点在修改前才复制(写时复制)。
+template<typename T>
+class TransientPVector {
+    friend class PVector<T>;
+    typedef PVecNode<T> Node;
+    typedef PVecBranch<T> Branch;
+    typedef PVecLeaf<T> Leaf;
+public:
+    TransientPVector() {}
+    explicit TransientPVector(const PVector<T> &v):v(v) {}
+
+    unsigned size() const {
+        return v.cnt;
+    }
+
+    const T& operator[](unsigned i) const {
+        return v[i];
+    }
+
+    TransientPVector &push_back(const T &x) {
+        unsigned tailn = v.cnt - v.tailoff();
+        if (tailn<Node::WIDTH) {
+            // tail还没有满
+            Leaf *t = editable_leaf(v.tail, tailn);
+            t->vals[tailn] = x;
+            v.tail = t;
+            ++v.cnt;
+            return *this;
+        }
+
+        // tail已满，把它放进树里
+        Leaf *full = v.tail;
+        if ((v.cnt >> Node::BITS) > (1u << v.shift)) {
+            // 根节点已满，树长高一层
+            Branch *nr = new Branch;
+            nr->kids[0] = v.root;
+            nr->kids[1] = new_path(v.shift, full);
+            v.root = nr;
+            v.shift += Node::BITS;
+        } else {
+            v.root = push_tail(v.shift, v.root, full);
+        }
+
+        Leaf *t = new Leaf;
+        t->vals[0] = x;
+        v.tail = t;
+        ++v.cnt;
+        return *this;
+    }
+
+    TransientPVector &set(unsigned i, const T &x) {
+        if (i>=v.cnt)
+            throw "PVector subscript out of range.";
+        if (i>=v.tailoff()) {
+            v.tail = editable_leaf(v.tail, v.cnt - v.tailoff());
+            v.tail->vals[i & Node::MASK] = x;
+            return *this;
+        }
+        v.root = do_set(v.shift, v.root, i, x);
+        return *this;
+    }
+
+    // 返回当前内容的不可变快照，之后的修改不会影响该快照
+    PVector<T> persistent() const {
+        return v;
+    }
+
+private:
+    // 取走当前内容，之后*this为空；不必像persistent()那样增加再减少引用计数
+    PVector<T> take() {
+        PVector<T> r;
+        r.swap(v);
+        return r;
+    }
+
+    // 返回一个可以原地修改的节点：若n被共享，复制一份并放弃对n的引用
+    static Branch *editable_branch(Node *n) {
+        if (!n) return new Branch;
+        Branch *b = static_cast<Branch *>(n);
+        if (b->use==1) return b;
+        Branch *nb = new Branch(*b);
+        --b->use;
+        return nb;
+    }
+
+    static Leaf *editable_leaf(Leaf *l, unsigned n) {
+        if (!l) return new Leaf;
+        if (l->use==1) return l;
+        Leaf *nl = new Leaf(*l, n);
+        --l->use;
+        return nl;
+    }
+
+    static Node *new_path(unsigned level, Leaf *leaf) {
+        if (level==0) return leaf;
+        Branch *b = new Branch;
+        b->kids[0] = new_path(level-Node::BITS, leaf);
+        return b;
+    }
+
+    Branch *push_tail(unsigned level, Node *parent, Leaf *leaf) {
+        Branch *b = editable_branch(parent);
+        unsigned sub = ((v.cnt-1) >> level) & Node::MASK;
+        if (level==Node::BITS) {
+            b->kids[sub] = leaf;
+        } else if (b->kids[sub]) {
+            b->kids[sub] = push_tail(level-Node::BITS, b->kids[sub], leaf);
+        } else {
+            b->kids[sub] = new_path(level-Node::BITS, leaf);
+        }
+        return b;
+    }
+
+    Node *do_set(unsigned level, Node *n, unsigned i, const T &x) {
+        if (level==0) {
+            Leaf *l = editable_leaf(static_cast<Leaf *>(n), Node::WIDTH);
+            l->vals[i & Node::MASK] = x;
+            return l;
+        }
+        Branch *b = editable_branch(n);
+        unsigned sub = (i >> level) & Node::MASK;
+        b->kids[sub] = do_set(level-Node::BITS, b->kids[sub], i, x);
+        return b;
+    }
+
+    PVector<T> v;
+};
+
+#endif
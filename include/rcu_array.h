@@ -0,0 +1,296 @@
+#ifndef RCU_ARRAY_H
+#define RCU_ARRAY_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "instrument.h"
+
+// 读-复制-更新(RCU)的数组
+// ArrayData::resize释放旧的缓冲区时，另一个线程中的Pointer可能还在读它。
+// RcuArray的写者从不修改读者可能看到的内存：需要更大的缓冲区或修改已有的元素时，
+// 先建好一个新的缓冲区，再用一次原子写发布；旧的缓冲区交给RcuDomain，
+// 等所有可能看到它的读者都结束后(宽限期)才释放。
+// 读者用snapshot()取得一个快照，整个过程不加锁也不等待，快照的内容在其生存期内不变。
+
+// 基于纪元(epoch)的回收：读者进入时记下当前纪元，离开时清除。
+// 只有当所有正在读的读者都已经看到当前纪元时，纪元才能前进；
+// 在纪元e退役的对象，纪元到达e+2时就不会再有读者引用它了。
+class RcuDomain{
+    struct Reader{
+        std::atomic<unsigned long long> epoch;  // 0表示不在读临界区中
+        std::atomic<bool> in_use;
+        unsigned nest;
+        Reader *next;
+        char pad[64];   // 不与其他读者的记录共享缓存行
+    };
+
+public:
+    static RcuDomain &instance() {
+        static RcuDomain d;
+        return d;
+    }
+
+    // 读临界区，可以嵌套；只能在创建它的线程中使用
+    class ReadGuard{
+    public:
+        ReadGuard():r(RcuDomain::instance().reader()) {
+            if (r->nest++==0) {
+                r->epoch.store(RcuDomain::instance().global.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+                // 先让写者看到我们在读，再读取被保护的指针
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+        ReadGuard(const ReadGuard &g):r(g.r) {r->nest++;}
+        ~ReadGuard() {
+            if (--r->nest==0)
+                r->epoch.store(0, std::memory_order_release);
+        }
+    private:
+        ReadGuard &operator=(const ReadGuard &);
+        Reader *r;
+    };
+
+    // 在宽限期后调用del(p)
+    void retire(void *p, void (*del)(void *)) {
+        std::lock_guard<std::mutex> lock(m);
+        Retired x = {p, del, global.load(std::memory_order_relaxed)};
+        retired.push_back(x);
+        advance();
+        collect();
+    }
+
+    // 等待一个完整的宽限期并释放所有退役的对象。不能在读临界区内调用
+    void synchronize() {
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                advance();
+                collect();
+                if (retired.empty())
+                    return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    unsigned pending() {
+        std::lock_guard<std::mutex> lock(m);
+        return unsigned(retired.size());
+    }
+
+private:
+    friend class ReadGuard;
+
+    struct Retired{
+        void *p;
+        void (*del)(void *);
+        unsigned long long epoch;
+    };
+
+    RcuDomain():global(1), readers(0) {}
+    ~RcuDomain() {
+        for (unsigned i=0; i!=retired.size(); i++)
+            retired[i].del(retired[i].p);
+        for (Reader *r=readers.load(); r; ) {
+            Reader *next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+    RcuDomain(const RcuDomain &);
+    RcuDomain &operator=(const RcuDomain &);
+
+    // 线程第一次读时领取一个读者记录，线程结束时归还；记录本身从不释放
+    struct Slot{
+        Reader *r;
+        Slot():r(RcuDomain::instance().acquire()) {}
+        ~Slot() {r->in_use.store(false, std::memory_order_release);}
+    };
+    Reader *reader() {
+        static thread_local Slot slot;
+        return slot.r;
+    }
+
+    Reader *acquire() {
+        for (Reader *r=readers.load(std::memory_order_acquire); r; r=r->next) {
+            bool idle = false;
+            if (r->in_use.compare_exchange_strong(idle, true))
+                return r;
+        }
+        Reader *r = new Reader;
+        r->epoch.store(0, std::memory_order_relaxed);
+        r->in_use.store(true, std::memory_order_relaxed);
+        r->nest = 0;
+        r->next = readers.load(std::memory_order_relaxed);
+        while (!readers.compare_exchange_weak(r->next, r, std::memory_order_release))
+            ;
+        return r;
+    }
+
+    // 所有读者都看到了当前纪元时前进一步
+    void advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const unsigned long long e = global.load(std::memory_order_relaxed);
+        for (Reader *r=readers.load(std::memory_order_acquire); r; r=r->next) {
+            unsigned long long re = r->epoch.load(std::memory_order_acquire);
+            if (re!=0 && re!=e)
+                return;
+        }
+        global.store(e+1, std::memory_order_release);
+    }
+
+    void collect() {
+        const unsigned long long e = global.load(std::memory_order_relaxed);
+        unsigned keep = 0;
+        for (unsigned i=0; i!=retired.size(); i++) {
+            if (retired[i].epoch + 2 <= e)
+                retired[i].del(retired[i].p);
+            else
+                retired[keep++] = retired[i];
+        }
+        retired.resize(keep);
+    }
+
+    std::atomic<unsigned long long> global;
+    std::atomic<Reader *> readers;
+    std::mutex m;
+    std::vector<Retired> retired;
+};
+
+template<typename T>
+class RcuArray;
+
+// 一个版本的元素。已经发布的元素不再改变；push_back只写入size之后的位置
+template<typename T>
+struct RcuBuffer{
+    explicit RcuBuffer(unsigned c):data(new T[c ? c : 1]), cap(c), sz(0) {}
+    ~RcuBuffer() {delete [] data;}
+
+    static void destroy(void *p) {delete static_cast<RcuBuffer *>(p);}
+
+    T *data;
+    unsigned cap;
+    std::atomic<unsigned> sz;
+};
+
+// 数组某一时刻的快照。快照存在期间其缓冲区不会被释放，写者也不会修改它的前size()个元素
+template<typename T>
+class RcuSnapshot{
+    friend class RcuArray<T>;
+public:
+    const T& operator[](unsigned i) const {
+        if (i>=sz)
+            throw "RcuSnapshot subscript out of range.";
+        return data[i];
+    }
+    unsigned size() const {return sz;}
+    const T *begin() const {return data;}
+    const T *end() const {return data + sz;}
+
+private:
+    explicit RcuSnapshot(const std::atomic<RcuBuffer<T> *> &cur) {
+        const RcuBuffer<T> *b = cur.load(std::memory_order_acquire);
+        data = b->data;
+        sz = b->sz.load(std::memory_order_acquire);
+    }
+
+    RcuDomain::ReadGuard guard;     // 必须先于读取指针
+    const T *data;
+    unsigned sz;
+};
+
+// 多个读者、一个时刻一个写者(写操作之间用锁串行化)
+template<typename T>
+class RcuArray{
+public:
+    RcuArray(unsigned n=0):cur(new RcuBuffer<T>(n)) {
+        cur.load()->sz.store(n, std::memory_order_relaxed);
+    }
+    // 析构时不能再有读者
+    ~RcuArray() {delete cur.load();}
+
+    RcuSnapshot<T> snapshot() const {
+        return RcuSnapshot<T>(cur);
+    }
+
+    unsigned size() const {
+        return cur.load(std::memory_order_acquire)->sz.load(std::memory_order_acquire);
+    }
+
+    // 有空余的位置时直接写入并发布新的大小；否则复制到两倍大的缓冲区
+    void push_back(const T &v) {
+        std::lock_guard<std::mutex> lock(m);
+        RcuBuffer<T> *b = cur.load(std::memory_order_relaxed);
+        unsigned n = b->sz.load(std::memory_order_relaxed);
+        if (n==b->cap) {
+            RcuBuffer<T> *nb = copy(*b, n, n ? 2*n : 1);
+            nb->data[n] = v;
+            nb->sz.store(n+1, std::memory_order_relaxed);
+            publish(nb);
+            return;
+        }
+        b->data[n] = v;
+        b->sz.store(n+1, std::memory_order_release);
+    }
+
+    // 修改已经发布的元素要复制整个数组，读者手中的快照不受影响
+    void set(unsigned i, const T &v) {
+        std::lock_guard<std::mutex> lock(m);
+        RcuBuffer<T> *b = cur.load(std::memory_order_relaxed);
+        unsigned n = b->sz.load(std::memory_order_relaxed);
+        if (i>=n)
+            throw "RcuArray subscript out of range.";
+        RcuBuffer<T> *nb = copy(*b, n, b->cap);
+        nb->data[i] = v;
+        nb->sz.store(n, std::memory_order_relaxed);
+        publish(nb);
+    }
+
+    void resize(unsigned news) {
+        std::lock_guard<std::mutex> lock(m);
+        RcuBuffer<T> *b = cur.load(std::memory_order_relaxed);
+        unsigned n = b->sz.load(std::memory_order_relaxed);
+        RcuBuffer<T> *nb = copy(*b, n<news ? n : news, news);
+        nb->sz.store(news, std::memory_order_relaxed);
+        publish(nb);
+    }
+
+    void reserve(unsigned s) {
+        std::lock_guard<std::mutex> lock(m);
+        RcuBuffer<T> *b = cur.load(std::memory_order_relaxed);
+        if (s<b->cap) return;
+        unsigned n = b->sz.load(std::memory_order_relaxed);
+        unsigned news = b->cap ? b->cap : 1;
+        while (news<=s)
+            news *= 2;
+        RcuBuffer<T> *nb = copy(*b, n, news);
+        nb->sz.store(n, std::memory_order_relaxed);
+        publish(nb);
+    }
+
+private:
+    RcuArray(const RcuArray &);
+    RcuArray &operator=(const RcuArray &);
+
+    static RcuBuffer<T> *copy(const RcuBuffer<T> &b, unsigned n, unsigned cap) {
+        RcuBuffer<T> *nb = new RcuBuffer<T>(cap);
+        INSTRUMENT_COUNT(ARRAY_COPY, n);
+        INSTRUMENT_COUNT(ARRAY_COPY_BYTES, (unsigned long long)n*sizeof(T));
+        for (unsigned i=0; i!=n; i++)
+            nb->data[i] = b.data[i];
+        return nb;
+    }
+
+    void publish(RcuBuffer<T> *nb) {
+        RcuBuffer<T> *old = cur.exchange(nb, std::memory_order_acq_rel);
+        RcuDomain::instance().retire(old, &RcuBuffer<T>::destroy);
+    }
+
+    std::atomic<RcuBuffer<T> *> cur;
+    std::mutex m;
+};
+
+#endif
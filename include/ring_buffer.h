@@ -0,0 +1,202 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include "array.h"
+
+// 有界的环形队列，用来在线程之间传递元素，不加锁
+// 元素保存在ArrayData中；容量取为2的幂，下标与capacity()-1做按位与即可回绕，
+// 不必取模，也不必做ArrayData::operator[]的边界检查。
+// head、tail是只增不减的计数器(按2^32回绕)，各自占一个缓存行，
+// 生产者与消费者修改各自的计数器时不会互相使对方的缓存行失效。
+//   SpscRing   一个生产者、一个消费者
+//   MpmcRing   多个生产者、多个消费者(Vyukov的有界队列：每个位置带一个序号)
+// 两者都提供批量的push/pop：一次只读写一次共享计数器，均摊了同步的开销。
+
+const unsigned RING_CACHE_LINE = 64;
+
+// 容量至少为n的最小的2的幂
+inline unsigned ring_capacity(unsigned n) {
+    if (n==0 || n>(1u<<31))
+        throw "bad ring capacity.";
+    unsigned c = 1;
+    while (c<n)
+        c *= 2;
+    return c;
+}
+
+template<typename T>
+class SpscRing{
+public:
+    explicit SpscRing(unsigned n):buf(ring_capacity(n)), mask(buf.sz-1),
+                                  head(0), tail_cache(0), tail(0), head_cache(0) {}
+
+    unsigned capacity() const {return mask+1;}
+    // 其他线程正在修改时只是一个近似值
+    unsigned size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    bool empty() const {return size()==0;}
+
+    // 只能由生产者调用；队列满时返回false
+    bool push(const T &v) {
+        const unsigned t = tail.load(std::memory_order_relaxed);
+        if (t-head_cache==capacity()) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t-head_cache==capacity())
+                return false;
+        }
+        buf.data[t & mask] = v;
+        tail.store(t+1, std::memory_order_release);
+        return true;
+    }
+    // 放入v[0..n)中尽可能多的元素，返回放入的个数
+    unsigned push(const T *v, unsigned n) {
+        const unsigned t = tail.load(std::memory_order_relaxed);
+        if (capacity()-(t-head_cache)<n)
+            head_cache = head.load(std::memory_order_acquire);
+        const unsigned room = capacity()-(t-head_cache);
+        if (n>room) n = room;
+        for (unsigned i=0; i!=n; i++)
+            buf.data[(t+i) & mask] = v[i];
+        tail.store(t+n, std::memory_order_release);
+        return n;
+    }
+
+    // 只能由消费者调用；队列空时返回false
+    bool pop(T &v) {
+        const unsigned h = head.load(std::memory_order_relaxed);
+        if (h==tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h==tail_cache)
+                return false;
+        }
+        v = buf.data[h & mask];
+        head.store(h+1, std::memory_order_release);
+        return true;
+    }
+    // 取出至多n个元素放到v中，返回取出的个数
+    unsigned pop(T *v, unsigned n) {
+        const unsigned h = head.load(std::memory_order_relaxed);
+        if (tail_cache-h<n)
+            tail_cache = tail.load(std::memory_order_acquire);
+        const unsigned avail = tail_cache-h;
+        if (n>avail) n = avail;
+        for (unsigned i=0; i!=n; i++)
+            v[i] = buf.data[(h+i) & mask];
+        head.store(h+n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    SpscRing(const SpscRing &);
+    SpscRing &operator=(const SpscRing &);
+
+    ArrayData<T> buf;
+    const unsigned mask;
+    char pad0[RING_CACHE_LINE];
+    // 消费者的缓存行：head与它看到的tail
+    std::atomic<unsigned> head;
+    unsigned tail_cache;
+    char pad1[RING_CACHE_LINE];
+    // 生产者的缓存行：tail与它看到的head，队列不满时不必读取head
+    std::atomic<unsigned> tail;
+    unsigned head_cache;
+    char pad2[RING_CACHE_LINE];
+};
+
+// MpmcRing的一个位置。seq==pos时可以写入第pos个元素，seq==pos+1时可以读出
+template<typename T>
+struct RingCell{
+    std::atomic<unsigned> seq;
+    T value;
+};
+
+template<typename T>
+class MpmcRing{
+public:
+    explicit MpmcRing(unsigned n):cells(ring_capacity(n)), mask(cells.sz-1), head(0), tail(0) {
+        for (unsigned i=0; i<=mask; i++)
+            cells.data[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    unsigned capacity() const {return mask+1;}
+    unsigned size() const {
+        const unsigned h = head.load(std::memory_order_acquire);
+        const unsigned t = tail.load(std::memory_order_acquire);
+        return int(t-h)>0 ? t-h : 0;
+    }
+    bool empty() const {return size()==0;}
+
+    bool push(const T &v) {return push(&v, 1)==1;}
+    bool pop(T &v) {return pop(&v, 1)==1;}
+
+    // 占用连续的k个空位置(k<=n)，只做一次CAS；返回放入的个数，队列满时为0
+    unsigned push(const T *v, unsigned n) {
+        if (n==0) return 0;
+        unsigned t = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            unsigned k = ready(t, n, 0);
+            if (k==0) {
+                // 第一个位置还没有被上一轮的消费者读走：队列满，或者tail已经过时
+                if (int(cells.data[t & mask].seq.load(std::memory_order_acquire) - t) < 0)
+                    return 0;
+                t = tail.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (tail.compare_exchange_weak(t, t+k, std::memory_order_relaxed)) {
+                for (unsigned i=0; i!=k; i++) {
+                    RingCell<T> &c = cells.data[(t+i) & mask];
+                    c.value = v[i];
+                    c.seq.store(t+i+1, std::memory_order_release);
+                }
+                return k;
+            }
+        }
+    }
+
+    unsigned pop(T *v, unsigned n) {
+        if (n==0) return 0;
+        unsigned h = head.load(std::memory_order_relaxed);
+        for (;;) {
+            unsigned k = ready(h, n, 1);
+            if (k==0) {
+                if (int(cells.data[h & mask].seq.load(std::memory_order_acquire) - (h+1)) < 0)
+                    return 0;
+                h = head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head.compare_exchange_weak(h, h+k, std::memory_order_relaxed)) {
+                for (unsigned i=0; i!=k; i++) {
+                    RingCell<T> &c = cells.data[(h+i) & mask];
+                    v[i] = c.value;
+                    c.seq.store(h+i+capacity(), std::memory_order_release);
+                }
+                return k;
+            }
+        }
+    }
+
+private:
+    MpmcRing(const MpmcRing &);
+    MpmcRing &operator=(const MpmcRing &);
+
+    // 从pos开始有几个(至多n个)位置的序号等于pos+i+off
+    unsigned ready(unsigned pos, unsigned n, unsigned off) const {
+        unsigned k = 0;
+        while (k!=n && k<=mask
+               && cells.data[(pos+k) & mask].seq.load(std::memory_order_acquire)==pos+k+off)
+            k++;
+        return k;
+    }
+
+    ArrayData<RingCell<T> > cells;
+    const unsigned mask;
+    char pad0[RING_CACHE_LINE];
+    std::atomic<unsigned> head;
+    char pad1[RING_CACHE_LINE];
+    std::atomic<unsigned> tail;
+    char pad2[RING_CACHE_LINE];
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <cstdint>
+#include <type_traits>
+#include "array.h"
+
+// 有序Array上的只读查找索引(Eytzinger布局)
+// 在有序数组上二分查找，前几步访问的位置相隔很远，每一步都可能是一次缓存未命中，
+// 而且下一步去哪里要等这次比较的结果，CPU无法提前取数。
+// EytzingerIndex把键按二叉堆的顺序重新排列：节点k的两个子节点是2k与2k+1，
+// 根附近的几层挤在开头的几个缓存行里，常驻缓存；
+// 节点k往下第4层的16个后代是连续的，正好一个缓存行(4字节的键)，可以提前预取。
+// 下降时用比较的结果直接算出下一个下标(k = 2k + (key<x))，没有分支可以预测错。
+// 批量查找把多个查找交错执行，让它们的缓存未命中重叠在一起。
+// 索引是原数组的一个副本，之后对原数组的修改不会反映到索引中。
+template<typename T>
+class EytzingerIndex{
+    static_assert(std::is_trivially_copyable<T>::value, "EytzingerIndex copies keys with plain assignment");
+public:
+    // 每个缓存行中的键数，也是预取时向下跳过的节点倍数；键的大小不是2的幂时不预取
+    static const unsigned LINE = 64,
+        BLOCK = sizeof(T)<=LINE && (sizeof(T) & (sizeof(T)-1))==0 ? LINE/sizeof(T) : 0,
+        GROUP = 8;
+
+    // a必须是升序的(允许相等的元素)
+    explicit EytzingerIndex(const Array<T> &a):n(a.size()), raw(0), keys(0), rank(0) {
+        for (unsigned i=1; i<n; i++)
+            if (a[i]<a[i-1])
+                throw "EytzingerIndex requires a sorted Array.";
+        // keys[0]不用；按缓存行对齐，使keys[BLOCK*k]开始一个缓存行
+        raw = new char[std::size_t(n+1)*sizeof(T) + LINE];
+        std::uintptr_t p = reinterpret_cast<std::uintptr_t>(raw);
+        keys = reinterpret_cast<T *>((p + LINE-1) / LINE * LINE);
+        keys[0] = T();
+        try {
+            rank = new unsigned[n+1];
+        } catch (...) {
+            delete [] raw;
+            throw;
+        }
+        rank[0] = n;
+        unsigned next = 0;
+        build(a, next);
+        levels = 0;
+        while ((2ull << levels) - 1 <= n)
+            levels++;
+    }
+    ~EytzingerIndex() {
+        delete [] raw;
+        delete [] rank;
+    }
+
+    unsigned size() const {return n;}
+
+    // 第一个不小于x的元素在原数组中的下标，没有时返回size()
+    unsigned lower_bound(const T &x) const {
+        return rank[node(x)];
+    }
+
+    bool contains(const T &x) const {
+        unsigned k = node(x);
+        return k!=0 && !(x<keys[k]);
+    }
+
+    // out[i] = lower_bound(xs[i])
+    void lower_bound(const T *xs, unsigned m, unsigned *out) const {
+        nodes(xs, m, out);
+        for (unsigned i=0; i!=m; i++)
+            out[i] = rank[out[i]];
+    }
+
+    // out[i] = contains(xs[i])，返回找到的个数
+    unsigned contains(const T *xs, unsigned m, bool *out) const {
+        unsigned hits = 0;
+        unsigned k[GROUP];
+        for (unsigned i=0; i<m; i+=GROUP) {
+            unsigned g = m-i<GROUP ? m-i : GROUP;
+            nodes(xs+i, g, k);
+            for (unsigned j=0; j!=g; j++)
+                hits += out[i+j] = k[j]!=0 && !(xs[i+j]<keys[k[j]]);
+        }
+        return hits;
+    }
+
+private:
+    EytzingerIndex(const EytzingerIndex &);
+    EytzingerIndex &operator=(const EytzingerIndex &);
+
+    // 按中序遍历把a中的元素依次放到节点k上
+    void build(const Array<T> &a, unsigned &next, unsigned k=1) {
+        if (k>n) return;
+        build(a, next, 2*k);
+        keys[k] = a[next];
+        rank[k] = next++;
+        build(a, next, 2*k+1);
+    }
+
+    // 第一个不小于x的键所在的节点，没有时为0
+    unsigned node(const T &x) const {
+        unsigned k = 1;
+        while (k<=n) {
+            prefetch(k);
+            k = 2*k + (keys[k]<x);
+        }
+        return found(k);
+    }
+
+    // out[i] = node(xs[i])，每GROUP个查找交错执行
+    void nodes(const T *xs, unsigned m, unsigned *out) const {
+        unsigned i = 0;
+        for (; i+GROUP<=m; i+=GROUP) {
+            unsigned k[GROUP];
+            for (unsigned j=0; j!=GROUP; j++)
+                k[j] = 1;
+            // 前levels层是满的，每个查找都要走完；最后一层可能不满，再走一步
+            for (unsigned l=0; l!=levels; l++)
+                for (unsigned j=0; j!=GROUP; j++) {
+                    prefetch(k[j]);
+                    k[j] = 2*k[j] + (keys[k[j]]<xs[i+j]);
+                }
+            for (unsigned j=0; j!=GROUP; j++) {
+                unsigned kk = k[j]<=n ? k[j] : 0;
+                unsigned step = 2*k[j] + (keys[kk]<xs[i+j]);
+                out[i+j] = found(kk ? step : k[j]);
+            }
+        }
+        for (; i!=m; i++)
+            out[i] = node(xs[i]);
+    }
+
+    // 下降结束时，k的二进制表示中最后一次向左(末尾的1之前的那个0)的节点就是答案；
+    // 一直向右时为0，即所有元素都小于x
+    static unsigned found(unsigned k) {
+        return k >> __builtin_ffs(~k);
+    }
+
+    // 预取k往下log2(BLOCK)层的后代。只是提示，越过末尾也不会出错
+    void prefetch(unsigned k) const {
+        if (BLOCK!=0)
+            __builtin_prefetch(reinterpret_cast<const void *>(
+                reinterpret_cast<std::uintptr_t>(keys) + std::uintptr_t(k)*BLOCK*sizeof(T)));
+    }
+
+    unsigned n;
+    char *raw;
+    T *keys;            // keys[1..n]
+    unsigned *rank;     // rank[k]：节点k在原数组中的下标，rank[0]==n
+    unsigned levels;    // 满的层数
+};
+
+#endif
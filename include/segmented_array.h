@@ -0,0 +1,145 @@
+#ifndef SEGMENTED_ARRAY_H
+#define SEGMENTED_ARRAY_H
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+// 分段数组：只能追加，可以被多个线程同时push_back
+// ArrayData增长时要重新分配并复制整个缓冲区，所以指向元素的地址会失效，
+// Pointer也只能靠保存下标来躲开这个问题。SegmentedArray由一组大小按2倍增长的段组成，
+// 第k段可以容纳FIRST<<k个元素。段一旦分配就不再移动，所以元素的地址永远有效。
+// push_back用CAS占一个下标(已满时不占)，段不存在时用CAS安装新段(失败者释放自己的)，
+// 不需要锁，也不会有线程因为别人在重新分配而等待。
+// 每个元素构造完成后在位图中置位，读者据此判断该元素是否已经可以读取，读操作不需要等待。
+template<typename T>
+class SegmentedArray{
+public:
+    enum { FIRST_BITS = 5, FIRST = 1 << FIRST_BITS, SEGMENTS = 32 - FIRST_BITS };
+
+    SegmentedArray():claimed(0) {
+        for (unsigned k=0; k!=SEGMENTS; k++)
+            segs[k].store(0, std::memory_order_relaxed);
+    }
+    ~SegmentedArray() {
+        for (unsigned k=0; k!=SEGMENTS; k++) {
+            Segment *s = segs[k].load(std::memory_order_relaxed);
+            if (!s) continue;
+            unsigned n = segment_size(k);
+            for (unsigned i=0; i!=n; i++)
+                if (s->ready(i))
+                    s->slot(i)->~T();
+            free_segment(s);
+        }
+    }
+
+    // 追加一个元素，返回它的下标。
+    // 下标占用后如果分配段或者复制v抛出异常，这个下标永远不会发布：
+    // 它仍然计入size()，get()返回空指针，operator[]抛出异常
+    unsigned push_back(const T &v) {
+        unsigned i = claimed.load(std::memory_order_relaxed);
+        do {
+            if (i >= capacity())
+                throw "SegmentedArray is full.";
+        } while (!claimed.compare_exchange_weak(i, i+1, std::memory_order_relaxed));
+        unsigned k, off;
+        locate(i, k, off);
+        Segment *s = segment(k);
+        new (s->slot(off)) T(v);
+        s->publish(off);
+        return i;
+    }
+
+    // 已经占用的下标数，其中可能有元素还没有构造完成
+    unsigned size() const {
+        unsigned n = claimed.load(std::memory_order_acquire);
+        return n<capacity() ? n : capacity();
+    }
+
+    // 下标为i的元素；还没有发布时返回空指针
+    const T *get(unsigned i) const {
+        if (i>=capacity()) return 0;
+        unsigned k, off;
+        locate(i, k, off);
+        const Segment *s = segs[k].load(std::memory_order_acquire);
+        if (!s || !s->ready(off)) return 0;
+        return s->slot(off);
+    }
+    T *get(unsigned i) {
+        return const_cast<T *>(static_cast<const SegmentedArray &>(*this).get(i));
+    }
+
+    const T& operator[](unsigned i) const {
+        const T *p = get(i);
+        if (!p)
+            throw "SegmentedArray subscript out of range.";
+        return *p;
+    }
+    T& operator[](unsigned i) {
+        return const_cast<T &>(static_cast<const SegmentedArray &>(*this)[i]);
+    }
+
+    static unsigned capacity() {
+        return unsigned(0) - FIRST;
+    }
+
+private:
+    SegmentedArray(const SegmentedArray &);
+    SegmentedArray &operator=(const SegmentedArray &);
+
+    // 段：元素的存储空间，加上每个元素一位的"已发布"位图
+    struct Segment{
+        std::atomic<std::uint64_t> *bits;
+        T *slots;
+
+        T *slot(unsigned i) const {return slots + i;}
+        bool ready(unsigned i) const {
+            return (bits[i>>6].load(std::memory_order_acquire) >> (i&63)) & 1;
+        }
+        void publish(unsigned i) {
+            bits[i>>6].fetch_or(std::uint64_t(1) << (i&63), std::memory_order_release);
+        }
+    };
+
+    static unsigned segment_size(unsigned k) {
+        return unsigned(FIRST) << k;
+    }
+
+    // 下标i位于第k段的第off个：i+FIRST的最高位决定段号
+    static void locate(unsigned i, unsigned &k, unsigned &off) {
+        unsigned pos = i + FIRST;
+        unsigned hb = 31 - __builtin_clz(pos);
+        k = hb - FIRST_BITS;
+        off = pos - (1u << hb);
+    }
+
+    Segment *segment(unsigned k) {
+        Segment *s = segs[k].load(std::memory_order_acquire);
+        if (s) return s;
+        Segment *ns = new_segment(segment_size(k));
+        if (segs[k].compare_exchange_strong(s, ns, std::memory_order_acq_rel))
+            return ns;
+        free_segment(ns);   // 别的线程已经安装了这一段
+        return s;
+    }
+
+    static Segment *new_segment(unsigned n) {
+        Segment *s = new Segment;
+        unsigned words = (n+63)/64;
+        s->bits = new std::atomic<std::uint64_t>[words];
+        for (unsigned w=0; w!=words; w++)
+            s->bits[w].store(0, std::memory_order_relaxed);
+        s->slots = static_cast<T *>(::operator new(sizeof(T) * std::size_t(n)));
+        return s;
+    }
+    static void free_segment(Segment *s) {
+        ::operator delete(s->slots);
+        delete [] s->bits;
+        delete s;
+    }
+
+    std::atomic<Segment *> segs[SEGMENTS];
+    std::atomic<unsigned> claimed;
+};
+
+#endif
@@ -0,0 +1,324 @@
+#ifndef SEQ_H
+#define SEQ_H
+
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include "instrument.h"
+
+template<typename T>
+class Seq ;
+template<typename T>
+class SeqInterner;
+template<typename T>
+class SeqItem {
+    friend class Seq<T>;
+    friend class SeqInterner<T>;
+    SeqItem(const T&d, SeqItem *n, int s=-1):use(1), shard(s), next(n), data(d){
+        INSTRUMENT_COUNT(SEQITEM_ALLOC, 1);
+    };
+
+    int use;
+    int shard;  // 所在的SeqInterner分片，-1表示该节点没有被驻留
+    SeqItem<T> *next;
+    T data;
+};
+
+// 驻留(hash-consing)的统计信息
+struct SeqInternStats {
+    unsigned long lookups;  // 驻留模式下cons的次数
+    unsigned long hits;     // 其中复用已有节点的次数
+    unsigned long nodes;    // 当前驻留的节点数
+    unsigned long bytes_saved; // 因复用而少分配的字节数
+
+    double hit_rate() const {
+        return lookups ? double(hits)/lookups : 0.0;
+    }
+};
+
+// T是否可以驻留。驻留要求std::hash<T>与operator==，所以由T选择加入：
+// 算术类型、枚举、指针与std::string缺省加入，其他类型可以特化为std::true_type。
+// 没有加入的T不会实例化SeqInterner<T>的任何操作，Seq<T>也就不需要这两者。
+template<typename T>
+struct seq_interning
+    :std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value
+                                  || std::is_pointer<T>::value> {};
+template<>
+struct seq_interning<std::string>:std::true_type {};
+
+// 驻留表：以(data, next)为键，相同的(值,尾部)只保存一个SeqItem。
+// 表按哈希值分片，每个分片一把锁，可以被多个线程同时使用。
+// 驻留节点的引用计数也在分片锁的保护下修改，因此不同线程里的Seq可以共享驻留节点。
+template<typename T>
+class SeqInterner {
+    friend class Seq<T>;
+    enum { SHARDS = 16 };
+
+    SeqInterner():lookups(0), hits(0), nodes(0) {}
+
+    static size_t hash(const T &d, const SeqItem<T> *n) {
+        size_t h = std::hash<T>()(d);
+        return h ^ (std::hash<const void *>()(n) + 0x9e3779b9 + (h<<6) + (h>>2));
+    }
+
+    // 返回(d, n)对应的驻留节点，其引用计数已为调用者加1。
+    // 调用者必须持有n的一个引用，n本身必须是驻留节点或者为空。
+    SeqItem<T> *cons(const T &d, SeqItem<T> *n) {
+        size_t h = hash(d, n);
+        int s = h % SHARDS;
+        ++lookups;
+        if (n) retain(n);   // 新节点持有n的引用，不能在持有分片锁时加锁另一个分片
+
+        std::unique_lock<std::mutex> lock(shards[s].m);
+        typedef typename std::unordered_multimap<size_t, SeqItem<T> *>::iterator iter;
+        std::pair<iter, iter> r = shards[s].table.equal_range(h);
+        for (iter it=r.first; it!=r.second; ++it) {
+            SeqItem<T> *i = it->second;
+            if (i->next==n && i->data==d) {
+                ++i->use;
+                INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+                lock.unlock();
+                ++hits;
+                if (n) release(n);  // 调用者仍持有n，所以n不会被释放
+                return i;
+            }
+        }
+        SeqItem<T> *i = new SeqItem<T>(d, n, s);
+        shards[s].table.insert(std::make_pair(h, i));
+        ++nodes;
+        return i;
+    }
+
+    void retain(SeqItem<T> *i) {
+        std::lock_guard<std::mutex> lock(shards[i->shard].m);
+        ++i->use;
+        INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+    }
+
+    // 引用计数减为0时把节点移出驻留表并返回true，由调用者负责delete
+    bool release(SeqItem<T> *i) {
+        Shard &sh = shards[i->shard];
+        std::lock_guard<std::mutex> lock(sh.m);
+        if (--i->use!=0) return false;
+
+        typedef typename std::unordered_multimap<size_t, SeqItem<T> *>::iterator iter;
+        std::pair<iter, iter> r = sh.table.equal_range(hash(i->data, i->next));
+        for (iter it=r.first; it!=r.second; ++it) {
+            if (it->second==i) {
+                sh.table.erase(it);
+                break;
+            }
+        }
+        --nodes;
+        return true;
+    }
+
+    SeqInternStats stats() const {
+        SeqInternStats st;
+        st.lookups = lookups;
+        st.hits = hits;
+        st.nodes = nodes;
+        st.bytes_saved = st.hits * sizeof(SeqItem<T>);
+        return st;
+    }
+
+    void reset_stats() {
+        lookups = 0;
+        hits = 0;
+    }
+
+    struct Shard {
+        std::mutex m;
+        std::unordered_multimap<size_t, SeqItem<T> *> table;
+    };
+    Shard shards[SHARDS];
+
+    std::atomic<unsigned long> lookups;
+    std::atomic<unsigned long> hits;
+    std::atomic<unsigned long> nodes;
+};
+
+template<typename T>
+class Seq {
+public:
+    Seq():item(0){};
+    // 驻留模式下，相同的(值,尾部)只会有一个节点；
+    // 只有尾部也是驻留的才驻留新节点，这样驻留的Seq的每个节点都是唯一的
+    Seq(const T &v, const Seq& s) {
+        if (Interning::value && interning_flag().load(std::memory_order_relaxed)
+            && (!s.item || s.item->shard>=0)) {
+            item = intern_cons(v, s.item, Interning());
+        } else {
+            retain(s.item);
+            item = new SeqItem<T>(v, s.item);
+        }
+    };
+    Seq(const Seq& s):item(s.item){retain(item);};
+
+    Seq& operator=(const Seq& s) {// s 并没有被改写，只是s.item->use被改写了, 所以可以用const修饰！！！
+        retain(s.item);
+        destroy(item);
+        item = s.item;
+        return *this;
+    }
+    ~Seq() {
+        destroy(item);
+    };
+
+    T hd() const {
+        if (item) return item->data;
+        else throw "hd of an empty Seq";
+    };
+
+    Seq tl() const{
+        if (item) return Seq(item->next);
+        else throw "tl of an empty Seq";
+    };
+
+    operator bool() { return item!=0; };
+
+    Seq& operator++() {
+        if (item) *this = Seq(item->next);
+        return *this;    
+    }
+    
+    T operator*()const{
+        return hd(); 
+    }
+
+    // 两个驻留的Seq相等当且仅当它们是同一个节点
+    bool operator==(const Seq &s) const {
+        SeqItem<T> *a = item, *b = s.item;
+        if (a && b && a->shard>=0 && b->shard>=0)
+            return a==b;
+        for (; a && b; a=a->next, b=b->next) {
+            if (a==b) return true;
+            if (!(a->data==b->data)) return false;
+        }
+        return a==b;
+    }
+    bool operator!=(const Seq &s) const {
+        return !(*this==s);
+    }
+
+    // 打开或关闭驻留模式(对所有Seq<T>有效)
+    static void interning(bool on) {
+        static_assert(Interning::value, "Seq<T> interning requires seq_interning<T>");
+        interning_flag().store(on, std::memory_order_relaxed);
+    }
+    // 增量回收：n为0(缺省)时，最后一个Seq析构时立即释放整条链；
+    // 否则每次析构或赋值最多释放n个节点，其余的留待以后，
+    // 这样释放一条很长的链不会让调用线程停顿太久。
+    // 挂起的链属于当前线程(节点的引用计数不是原子的，不能交给别的线程释放)。
+    static void reclaim_slice(unsigned n) {
+        reclaim_slice_size() = n;
+    }
+    // 释放当前线程挂起的至多budget个节点，返回实际释放的个数
+    static unsigned reclaim(unsigned budget) {
+        return reclaim(pending(), budget);
+    }
+    static void reclaim_all() {
+        reclaim(pending(), ~0u);
+    }
+    static bool reclaim_pending() {
+        return !pending().empty();
+    }
+
+    static SeqInternStats intern_stats() {
+        static_assert(Interning::value, "Seq<T> interning requires seq_interning<T>");
+        return interner().stats();
+    }
+    static void reset_intern_stats() {
+        static_assert(Interning::value, "Seq<T> interning requires seq_interning<T>");
+        interner().reset_stats();
+    }
+
+private:
+    typedef std::integral_constant<bool, seq_interning<T>::value> Interning;
+
+    static std::atomic<bool> &interning_flag() {
+        static std::atomic<bool> on(false);
+        return on;
+    }
+    static SeqInterner<T> &interner() {
+        static SeqInterner<T> in;
+        return in;
+    }
+    // 只有T加入驻留时才调用SeqInterner的操作；否则不会有驻留的节点(shard总是-1)，
+    // 下面false_type的版本不会被执行，只是让SeqInterner<T>的操作不被实例化
+    static SeqItem<T> *intern_cons(const T &v, SeqItem<T> *n, std::true_type) {
+        return interner().cons(v, n);
+    }
+    static SeqItem<T> *intern_cons(const T &v, SeqItem<T> *n, std::false_type) {
+        return new SeqItem<T>(v, n);
+    }
+    static void intern_retain(SeqItem<T> *i, std::true_type) {interner().retain(i);}
+    static void intern_retain(SeqItem<T> *, std::false_type) {}
+    static bool intern_release(SeqItem<T> *i, std::true_type) {return interner().release(i);}
+    static bool intern_release(SeqItem<T> *i, std::false_type) {return --i->use==0;}
+
+    static std::atomic<unsigned> &reclaim_slice_size() {
+        static std::atomic<unsigned> n(0);
+        return n;
+    }
+    // 每个线程挂起的死链，线程退出时全部释放
+    struct Pending : std::vector<SeqItem<T> *> {
+        ~Pending() { reclaim(*this, ~0u); }
+    };
+    static unsigned reclaim(std::vector<SeqItem<T> *> &p, unsigned budget) {
+        unsigned freed = 0;
+        while (freed!=budget && !p.empty()) {
+            SeqItem<T> *i = p.back();
+            SeqItem<T> *next = i->next;
+            delete i;
+            ++freed;
+            if (next&&release(next)) p.back() = next;
+            else p.pop_back();
+        }
+        return freed;
+    }
+    static std::vector<SeqItem<T> *> &pending() {
+        static thread_local Pending p;
+        return p;
+    }
+
+    static void retain(SeqItem<T> *i) {
+        if (!i) return;
+        if (i->shard<0) {
+            ++i->use;
+            INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+        } else {
+            intern_retain(i, Interning());
+        }
+    }
+    // 引用计数减为0时返回true
+    static bool release(SeqItem<T> *i) {
+        if (i->shard<0) return --i->use==0;
+        return intern_release(i, Interning());
+    }
+
+    void destroy(SeqItem<T> *i) {
+        if (reclaim_slice_size()==0) {
+            SeqItem<T> *next = i;
+            while (i&&release(i)) {
+                next = i->next;
+                delete i;
+                i = next; 
+            }
+            return;
+        }
+        // 增量回收：死掉的链先挂起，每次只释放一小段
+        if (i&&release(i))
+            pending().push_back(i);
+        reclaim(reclaim_slice_size());
+    }
+    Seq(SeqItem<T> *si):item(si){retain(item);};
+
+    SeqItem<T> *item;
+};
+
+#endif
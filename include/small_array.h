@@ -0,0 +1,111 @@
+#ifndef SMALL_ARRAY_H
+#define SMALL_ARRAY_H
+
+#include <new>
+#include "array.h"
+
+// 小数组优化
+// Array<T>至少需要两次分配：ArrayData对象本身和它的元素。
+// SmallArray<T, N>把不超过N个元素直接保存在对象内部，不分配任何内存；
+// 只有增长到超过N个元素时才把元素搬到一个ArrayData中。
+// 元素可能位于对象内部，所以SmallArray不支持Pointer。
+// 内部的空间是未构造的原始存储，只构造前size()个元素，空的SmallArray不构造任何T。
+template<typename T, unsigned N>
+class SmallArray{
+public:
+    SmallArray(unsigned n=0):sz(0), pa(0) {resize(n);}
+    ~SmallArray() {
+        shrink(0);
+        if(pa && --pa->used==0) delete pa;
+    }
+
+    SmallArray(const SmallArray &a):sz(0), pa(0) {
+        assign(a);
+    }
+    SmallArray &operator=(const SmallArray &a) {
+        if (this != &a)
+            assign(a);
+        return *this;
+    }
+
+    const T& operator[](unsigned i) const {
+        if (pa) return (*pa)[i];
+        if (i>=sz)
+            throw "SmallArray subscript out of range.";
+        return elems()[i];
+    }
+    T& operator[](unsigned i) {
+        return const_cast<T &>(static_cast<const SmallArray &>(*this)[i]);
+    }
+
+    unsigned size() const {return pa ? pa->size() : sz;}
+
+    // 元素是否仍然保存在对象内部
+    bool is_inline() const {return pa==0;}
+
+    // 新增的元素都是T()，无论元素在对象内部还是在ArrayData中
+    void resize(unsigned news) {
+        if (pa) {
+            unsigned old = pa->size();
+            pa->resize(news);
+            for (unsigned i=old; i<news; i++)
+                pa->data[i] = T();
+        } else if (news<=N) {
+            shrink(news);
+            for (; sz<news; sz++)
+                new (elems()+sz) T();
+        } else {
+            spill(news);
+        }
+    }
+
+    // 与Array::reserve一样按2倍增长
+    void reserve(unsigned s) {
+        if (pa) {
+            pa->reserve(s);
+            return;
+        }
+        if (s<sz) return;
+        unsigned news = sz ? sz : 1;
+        while (news<=s)
+            news *= 2;
+        resize(news);
+    }
+
+private:
+    T *elems() {return reinterpret_cast<T *>(buf);}
+    const T *elems() const {return reinterpret_cast<const T *>(buf);}
+
+    // 析构内部第n个以后的元素
+    void shrink(unsigned n) {
+        for (; sz>n; sz--)
+            elems()[sz-1].~T();
+    }
+
+    void spill(unsigned news) {
+        ArrayData<T> *np = new ArrayData<T>(news);
+        try {
+            np->copy(elems(), sz);
+            for (unsigned i=sz; i<news; i++)
+                np->data[i] = T();
+        } catch (...) {
+            delete np;
+            throw;
+        }
+        shrink(0);
+        pa = np;
+    }
+
+    void assign(const SmallArray &a) {
+        unsigned n = a.size();
+        resize(n);
+        for (unsigned i=0; i!=n; i++)
+            (*this)[i] = a[i];
+    }
+
+    unsigned sz;        // 内部保存的元素个数(pa为空时有效)
+    ArrayData<T> *pa;   // 溢出后的元素
+    alignas(T) unsigned char buf[N ? N*sizeof(T) : 1];  // 前sz个元素已经构造
+};
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef SOA_H
+#define SOA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <tuple>
+#include <utility>
+
+// 结构数组(structure of arrays)
+// Array<R>把记录一个接一个的存放(array of structs)，只扫描一个字段时，
+// 其他字段也被一同读入缓存。SoaArray把每个字段存放在单独的一列中，
+// 扫描一个字段只读取这一列；每一列都按缓存行对齐，便于编译器向量化。
+// 需要哪些字段由模板参数在编译时指定：
+//     SoaArray<Particle, SOA_FIELD(Particle, x), SOA_FIELD(Particle, vx)> a(n);
+
+template<typename M, M Ptr>
+struct SoaField;
+
+template<typename R, typename T, T R::*Ptr>
+struct SoaField<T R::*, Ptr> {
+    typedef R record;
+    typedef T type;
+    static T& get(R &r) {return r.*Ptr;}
+    static const T& get(const R &r) {return r.*Ptr;}
+};
+
+#define SOA_FIELD(R, m) SoaField<decltype(&R::m), &R::m>
+
+// 一列：对齐到缓存行的连续内存
+template<typename T>
+class SoaColumn{
+public:
+    enum { ALIGN = 64 };
+
+    SoaColumn():raw(0), data(0), sz(0) {}
+    ~SoaColumn() {release();}
+
+    SoaColumn(const SoaColumn &c):SoaColumn(c, c.sz) {}
+    SoaColumn &operator=(const SoaColumn &c) {
+        if (this != &c) {
+            SoaColumn t(c);
+            swap(t);
+        }
+        return *this;
+    }
+
+    // 长度为news的列，前面的元素从c复制，其余的为T()。
+    // 构造元素时抛出异常，就析构已经构造的元素并释放缓冲区
+    SoaColumn(const SoaColumn &c, unsigned news):raw(0), data(0), sz(0) {
+        raw = std::malloc(news*sizeof(T) + ALIGN);
+        if (!raw) throw std::bad_alloc();
+        data = reinterpret_cast<T *>(
+            (reinterpret_cast<std::size_t>(raw) + ALIGN) & ~std::size_t(ALIGN-1));
+        try {
+            for (; sz!=news && sz!=c.sz; sz++)
+                new (data+sz) T(c.data[sz]);
+            for (; sz<news; sz++)
+                new (data+sz) T();
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    // 抛出异常时原来的列不变
+    void resize(unsigned news) {
+        if (news==sz) return;
+        SoaColumn t(*this, news);
+        swap(t);
+    }
+    // 把改变长度后的副本放到out中，*this不变
+    void resized(unsigned news, SoaColumn &out) const {
+        SoaColumn t(*this, news);
+        out.swap(t);
+    }
+
+    void swap(SoaColumn &c) {
+        std::swap(raw, c.raw);
+        std::swap(data, c.data);
+        std::swap(sz, c.sz);
+    }
+
+    T *get() const {return data;}
+
+private:
+    void release() {
+        for (unsigned i=0; i!=sz; i++)
+            data[i].~T();
+        std::free(raw);
+        raw = 0;
+        data = 0;
+        sz = 0;
+    }
+
+    void *raw;
+    T *data;
+    unsigned sz;
+};
+
+template<typename R, typename... F>
+class SoaArray;
+
+// 代表一条记录的代理，读写都直接作用在各列上
+template<typename R, typename... F>
+class SoaRef{
+    friend class SoaArray<R, F...>;
+public:
+    template<unsigned I>
+    typename std::tuple_element<I, std::tuple<typename F::type...> >::type &get() const {
+        return a->template column<I>()[index];
+    }
+
+    // 读出整条记录(只填写列出的字段)
+    R load() const {
+        R r;
+        load(r, std::index_sequence_for<F...>());
+        return r;
+    }
+    operator R() const {return load();}
+
+    const SoaRef &operator=(const R &r) const {
+        store(r, std::index_sequence_for<F...>());
+        return *this;
+    }
+    // a[i] = a[j]：复制元素的每个字段，而不是让代理指向另一个元素
+    SoaRef(const SoaRef &) = default;
+    const SoaRef &operator=(const SoaRef &r) const {
+        copy(r, std::index_sequence_for<F...>());
+        return *this;
+    }
+
+private:
+    SoaRef(SoaArray<R, F...> *arr, unsigned i):a(arr), index(i) {}
+
+    template<std::size_t... I>
+    void load(R &r, std::index_sequence<I...>) const {
+        int expand[] = {0, (F::get(r) = a->template column<I>()[index], 0)...};
+        (void)expand;
+    }
+    template<std::size_t... I>
+    void store(const R &r, std::index_sequence<I...>) const {
+        int expand[] = {0, (a->template column<I>()[index] = F::get(r), 0)...};
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    void copy(const SoaRef &r, std::index_sequence<I...>) const {
+        int expand[] = {0, (a->template column<I>()[index] = r.a->template column<I>()[r.index], 0)...};
+        (void)expand;
+    }
+
+    SoaArray<R, F...> *a;
+    unsigned index;
+};
+
+// 类似Pointer：保存数组与下标，每次访问都重新定位，所以resize后仍然有效
+template<typename R, typename... F>
+class SoaPointer{
+public:
+    SoaPointer():a(0), index(0) {}
+    SoaPointer(SoaArray<R, F...> &arr, unsigned i=0):a(&arr), index(i) {}
+
+    SoaRef<R, F...> operator*() const {
+        if (0==a) throw "* of unbound SoaPointer";
+        return (*a)[index];
+    }
+
+    SoaPointer &operator++() {++index; return *this;}
+    SoaPointer operator++(int) {SoaPointer tmp(*this); ++index; return tmp;}
+    SoaPointer &operator--() {--index; return *this;}
+    SoaPointer operator--(int) {SoaPointer tmp(*this); --index; return tmp;}
+
+    bool operator==(const SoaPointer &p) const {return a==p.a && index==p.index;}
+    bool operator!=(const SoaPointer &p) const {return !(*this==p);}
+
+private:
+    SoaArray<R, F...> *a;
+    unsigned index;
+};
+
+template<typename R, typename... F>
+class SoaArray{
+public:
+    SoaArray(unsigned n=0):sz(0) {resize(n);}
+
+    unsigned size() const {return sz;}
+
+    // 第I列的首地址，按缓存行对齐
+    template<unsigned I>
+    typename std::tuple_element<I, std::tuple<typename F::type...> >::type *column() const {
+        return std::get<I>(cols).get();
+    }
+
+    SoaRef<R, F...> operator[](unsigned i) {
+        if (i>=sz)
+            throw "SoaArray subscript out of range.";
+        return SoaRef<R, F...>(this, i);
+    }
+    R operator[](unsigned i) const {
+        return const_cast<SoaArray &>(*this)[i].load();
+    }
+
+    void resize(unsigned n) {
+        resize(n, std::index_sequence_for<F...>());
+        sz = n;
+    }
+
+    // 与Array::reserve一样按2倍增长
+    void reserve(unsigned s) {
+        if (s<sz) return;
+        unsigned news = sz ? sz : 1;
+        while (news<=s)
+            news *= 2;
+        resize(news);
+    }
+
+private:
+    // 先在next中建好所有的新列，再一起换入；
+    // 中途抛出异常时已经建好的新列随next释放，原来的各列仍然一样长
+    template<std::size_t... I>
+    void resize(unsigned n, std::index_sequence<I...>) {
+        std::tuple<SoaColumn<typename F::type>...> next;
+        int build[] = {0, (std::get<I>(cols).resized(n, std::get<I>(next)), 0)...};
+        int install[] = {0, (std::get<I>(cols).swap(std::get<I>(next)), 0)...};
+        (void)build;
+        (void)install;
+    }
+
+    std::tuple<SoaColumn<typename F::type>...> cols;
+    unsigned sz;
+};
+
+#endif
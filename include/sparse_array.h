@@ -0,0 +1,301 @@
+#ifndef SPARSE_ARRAY_H
+#define SPARSE_ARRAY_H
+
+#include <cstddef>
+#include "array.h"
+
+// 稀疏数组
+// Array在a.reserve(200); a[200] = 1;之后要分配400个元素，即使只有一个元素被用到。
+// SparseArray把下标空间分成PAGE个元素一页，只有被写过(通过非const的operator[])的页才分配，
+// 页目录与每一页都是一个ArrayData。没有分配的页中的元素都是T()。
+// 接口与Array相同，Pointer换成了SparsePointer；for_each只访问不等于T()的元素。
+template<typename T>
+class SparseArray;
+template<typename T>
+class SparsePtr_to_const;
+template<typename T>
+class SparsePointer;
+
+// 稀疏数组实现类，与ArrayData一样带有引用计数，由SparseArray与指针类共享
+template<typename T>
+class SparseData{
+    friend class SparseArray<T>;
+    friend class SparsePtr_to_const<T>;
+    friend class SparsePointer<T>;
+
+    enum { PAGE_BITS = 6, PAGE = 1 << PAGE_BITS };
+
+    SparseData(unsigned n=0):sz(0), dir(0), def(), used(1) {resize(n);}
+    ~SparseData() {release(0);}
+
+    SparseData(const SparseData &d):sz(0), dir(0), def(), used(1) {
+        clone(d);
+    }
+
+    void clone(const SparseData &d) {
+        release(0);
+        dir.resize(d.dir.size());
+        for (unsigned k=0; k!=dir.size(); k++)
+            dir[k] = d.dir[k] ? new ArrayData<T>(*d.dir[k]) : 0;
+        sz = d.sz;
+    }
+
+    static unsigned pages_for(unsigned n) {
+        return (n + PAGE - 1) >> PAGE_BITS;
+    }
+
+    // 只读访问不分配页
+    const T& operator[](unsigned i) const {
+        if (i>=sz)
+            throw "SparseArray subscript out of range.";
+        const ArrayData<T> *p = dir.data[i >> PAGE_BITS];
+        return p ? p->data[i & (PAGE-1)] : def;
+    }
+    // 可写访问在需要时分配该页
+    T& operator[](unsigned i) {
+        if (i>=sz)
+            throw "SparseArray subscript out of range.";
+        ArrayData<T> *&p = dir.data[i >> PAGE_BITS];
+        if (!p) {
+            // new T[]不会初始化内置类型，新页中其余的元素必须是T()
+            p = new ArrayData<T>(PAGE);
+            for (unsigned k=0; k!=PAGE; k++)
+                p->data[k] = def;
+        }
+        return p->data[i & (PAGE-1)];
+    }
+
+    void resize(unsigned news) {
+        if (news==sz) return;
+        unsigned np = pages_for(news);
+        release(np);
+        dir.resize(np);
+        for (unsigned k=pages_for(sz); k<np; k++)
+            dir[k] = 0;
+        // 缩小时把最后一页中被截掉的部分恢复为T()，再次增长后它们仍然是T()
+        unsigned i = news & (PAGE-1);
+        if (news<sz && i && dir[np-1])
+            for (; i!=PAGE; i++)
+                dir[np-1]->data[i] = T();
+        sz = news;
+    }
+
+    void reserve(unsigned s) {
+        if (s<sz) return ;
+
+        unsigned news = sz;
+        if (news==0) news = 1;
+
+        while (news<=s) {
+            news *= 2;
+        }
+        resize(news);
+    }
+
+    // 释放第first页及以后的页
+    void release(unsigned first) {
+        for (unsigned k=first; k<dir.size(); k++) {
+            delete dir[k];
+            dir[k] = 0;
+        }
+    }
+
+    unsigned size() const {
+        return sz;
+    }
+
+    unsigned pages() const {
+        unsigned n = 0;
+        for (unsigned k=0; k!=dir.size(); k++)
+            if (dir.data[k]) n++;
+        return n;
+    }
+
+    std::size_t bytes() const {
+        return std::size_t(pages())*PAGE*sizeof(T)
+             + std::size_t(dir.size())*sizeof(ArrayData<T> *);
+    }
+
+    template<typename F>
+    void for_each(F f) const {
+        for (unsigned k=0; k!=dir.size(); k++) {
+            const ArrayData<T> *p = dir.data[k];
+            if (!p) continue;
+            unsigned base = k*PAGE, n = sz-base<unsigned(PAGE) ? sz-base : unsigned(PAGE);
+            for (unsigned i=0; i!=n; i++)
+                if (!(p->data[i]==def))
+                    f(base+i, p->data[i]);
+        }
+    }
+
+    unsigned sz;
+    ArrayData<ArrayData<T> *> dir;
+    T def;
+
+    int used;
+};
+
+template<typename T>
+class SparseArray{
+public:
+    friend class SparsePointer<T>;
+    friend class SparsePtr_to_const<T>;
+
+    enum { PAGE = SparseData<T>::PAGE };
+
+    SparseArray(unsigned n=0):pd(new SparseData<T>(n)){}
+    ~SparseArray(){if(--pd->used==0)delete pd;}
+
+    SparseArray(const SparseArray& a):pd(new SparseData<T>(*(a.pd))) {}
+
+    SparseArray &operator=(const SparseArray &a) {
+        if (this != &a)
+            pd->clone(*(a.pd));
+        return *this;
+    }
+
+    const T& operator[](unsigned i) const{
+        return (*static_cast<const SparseData<T> *>(pd))[i];
+    }
+    T& operator[](unsigned i){
+        return (*pd)[i];
+    }
+
+    void resize(unsigned s)
+    {
+       pd->resize(s);
+    }
+
+    void reserve(unsigned s)
+    {
+        pd->reserve(s);
+    }
+
+    unsigned size()const
+    {
+        return pd->size();
+    }
+
+    // 已经分配的页数，以及页与页目录占用的字节数
+    unsigned pages() const {return pd->pages();}
+    std::size_t bytes() const {return pd->bytes();}
+
+    // 按下标顺序访问不等于T()的元素：f(下标, 元素)。跳过没有分配的页
+    template<typename F>
+    void for_each(F f) const {
+        pd->for_each(f);
+    }
+
+private:
+    SparseData<T> *pd;
+};
+
+// 指向const SparseArray的指针类，与Ptr_to_const一样保存下标，并共享实现类
+template<typename T>
+class SparsePtr_to_const{
+public:
+    SparsePtr_to_const():pd(0),index(0){}
+    SparsePtr_to_const(const SparseArray<T>& a, unsigned i=0):pd(a.pd),index(i){retain(pd);}
+    ~SparsePtr_to_const(){if(pd&&--pd->used==0)delete pd;}
+    SparsePtr_to_const(const SparsePtr_to_const &p):pd(p.pd), index(p.index) {
+            retain(pd);}
+    SparsePtr_to_const &operator=(const SparsePtr_to_const &p){
+        retain(p.pd);
+        if (pd && --pd->used==0) delete pd;
+        pd = p.pd;
+        index = p.index;
+        return *this;
+    }
+
+    // 读取不会分配页
+    const T* operator->() const {
+        if (0==pd)throw "-> of unbound SparsePointer";
+        else return &((*static_cast<const SparseData<T> *>(pd))[index]);
+    }
+    const T& operator*() const {
+        if (0==pd)throw "* of unbound SparsePointer";
+        else return (*static_cast<const SparseData<T> *>(pd))[index];
+    }
+
+    SparsePtr_to_const& operator++() {
+        index++;
+        return *this;
+    }
+    SparsePtr_to_const operator++(int){
+        SparsePtr_to_const tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+    SparsePtr_to_const& operator--() {
+        index--;
+        return *this;
+    }
+    SparsePtr_to_const operator--(int){
+        SparsePtr_to_const tmp(*this);
+        --(*this);
+        return tmp;
+    }
+
+    bool operator==(const SparsePtr_to_const &p) const {
+        return pd==p.pd && index==p.index;
+    }
+    bool operator!=(const SparsePtr_to_const &p) const {
+        return !(*this==p);
+    }
+    int operator-(const SparsePtr_to_const &p) const {
+        if (pd!=p.pd)
+            throw "";
+        return index-p.index;
+    }
+
+protected:
+    static void retain(SparseData<T> *pd) {
+        if (pd) {
+            pd->used++;
+            INSTRUMENT_COUNT(REFCOUNT_INC, 1);
+        }
+    }
+
+    SparseData<T> *pd;
+    unsigned index;
+};
+
+// 指向SparseArray的指针类
+template<typename T>
+class SparsePointer:public SparsePtr_to_const<T>{
+public:
+    SparsePointer(SparseArray<T> &a, unsigned i=0):SparsePtr_to_const<T>(a,i) {}
+    SparsePointer() {}
+    using SparsePtr_to_const<T>::pd;
+    using SparsePtr_to_const<T>::index;
+    // 写入会分配该页
+    T* operator->() const {
+        if (0==pd)throw "-> of unbound SparsePointer";
+        else return &((*pd)[index]);
+    }
+    T& operator*() const {
+        if (0==pd)throw "* of unbound SparsePointer";
+        else return (*pd)[index];
+    }
+
+    SparsePointer& operator++() {
+        index++;
+        return *this;
+    }
+    SparsePointer operator++(int){
+        SparsePointer tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+    SparsePointer& operator--() {
+        index--;
+        return *this;
+    }
+    SparsePointer operator--(int){
+        SparsePointer tmp(*this);
+        --(*this);
+        return tmp;
+    }
+};
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "instrument.h"
+
+// 继承树
+class Super{
+public:
+    virtual ~Super() {}   // 通过Super*删除子类对象
+    virtual void f() {std::cout << "f() in super ."<< std::endl;}
+    virtual Super* clone()const {INSTRUMENT_COUNT(SUPER_CLONE, 1); return new Super();}
+};
+class Sub1:public Super{
+public:
+    virtual void f() {std::cout << "f() in sub1 ."<< std::endl;}
+    virtual Super* clone()const {INSTRUMENT_COUNT(SUPER_CLONE, 1); return new Sub1();}
+};
+class Sub2:public Super{
+public:
+    virtual void f() {std::cout << "f() in sub2 ."<< std::endl;}
+    virtual Super* clone()const {INSTRUMENT_COUNT(SUPER_CLONE, 1); return new Sub2();}
+};
+
+
+// 代理类
+// 通常Surrogate独占其所代理的对象。从SurrogateArena中借用对象的Surrogate(见surrogate_io.h)
+// 不负责释放对象；复制这样的Surrogate时仍然克隆，得到的副本独占新的对象。
+class Surrogate{
+public:
+        Surrogate():p(0), owner(true) {}   
+        Surrogate(const Super&s):p(s.clone()), owner(true) {}
+        Surrogate(const Surrogate&s):p(s.p?s.p->clone():0), owner(true) {}
+        Surrogate &operator=(const Surrogate &s){
+                if (this!=&s) {
+                        if (owner) delete p;
+                        p = s.p?s.p->clone():0;
+                        owner = true;
+                }
+                return *this;
+        }
+        // 移动不克隆，借用的仍是借用的；vector扩容时也不会逐个克隆
+        Surrogate(Surrogate&&s) noexcept:p(s.p), owner(s.owner) {s.p = 0; s.owner = true;}
+        Surrogate &operator=(Surrogate &&s) noexcept{
+                if (this!=&s) {
+                        if (owner) delete p;
+                        p = s.p;
+                        owner = s.owner;
+                        s.p = 0;
+                        s.owner = true;
+                }
+                return *this;
+        }
+        ~Surrogate(){if (owner) delete p;}
+
+
+        void f() {return p->f();} //
+
+        Super * operator->(){return p;} // C++ 重载 ‘->’ 操作符！
+        Super & operator*(){return *p;} // C++ 重载 ‘*’ 操作符！
+
+        Super *get(){return p;}
+        //Super &get(){return *p;}
+
+        // 是否负责释放所代理的对象
+        bool owns() const {return owner;}
+
+        // 改为代理q；own为false时只是借用q，由q的所有者负责释放
+        void reset(Super *q, bool own=true){
+                if (owner && p!=q) delete p;
+                p = q;
+                owner = own;
+        }
+
+        // 放弃对所代理对象的所有权，由调用者负责释放；借用的对象返回一个克隆
+        Super *release(){
+                Super *t = owner||!p ? p : p->clone();
+                p = 0;
+                owner = true;
+                return t;
+        }
+
+private:
+        Super *p;            
+        bool owner;
+};
+
+// 回收大量Surrogate所代理的对象
+// 一次释放几百万个对象会让调用线程停顿很久。SurrogateReclaimer接管这些对象，
+// 由后台线程释放(background为true)，或者由调用者分多次调用reclaim逐步释放。
+// Surrogate独占其所代理的对象，所以可以安全的交给另一个线程释放。
+class SurrogateReclaimer{
+public:
+        SurrogateReclaimer(bool background=true):stopping(false), busy(false) {
+                if (background)
+                        worker = std::thread(&SurrogateReclaimer::run, this);
+        }
+        ~SurrogateReclaimer() {
+                {
+                        std::lock_guard<std::mutex> lock(m);
+                        stopping = true;
+                }
+                cv.notify_one();
+                if (worker.joinable())
+                        worker.join();
+                reclaim(~0u);
+        }
+
+        // 接管v中所有的对象并清空v，v的析构不再需要释放任何东西
+        void retire(std::vector<Surrogate> &v) {
+                std::vector<Super *> batch;
+                batch.reserve(v.size());
+                // 借用的对象由其SurrogateArena释放，不必克隆后再交给这里
+                for (std::vector<Surrogate>::iterator it=v.begin(); it!=v.end(); ++it)
+                        if (it->owns())
+                                if (Super *p = it->release())
+                                        batch.push_back(p);
+                v.clear();
+                {
+                        std::lock_guard<std::mutex> lock(m);
+                        dead.insert(dead.end(), batch.begin(), batch.end());
+                }
+                cv.notify_one();
+        }
+
+        // 在调用线程释放至多budget个对象，返回实际释放的个数
+        unsigned reclaim(unsigned budget) {
+                std::vector<Super *> batch;
+                {
+                        std::lock_guard<std::mutex> lock(m);
+                        while (batch.size()!=budget && !dead.empty()) {
+                                batch.push_back(dead.front());
+                                dead.pop_front();
+                        }
+                }
+                for (unsigned i=0; i!=batch.size(); i++)
+                        delete batch[i];
+                return batch.size();
+        }
+
+        unsigned pending() {
+                std::lock_guard<std::mutex> lock(m);
+                return dead.size();
+        }
+
+        // 等待后台线程释放完所有对象
+        void drain() {
+                std::unique_lock<std::mutex> lock(m);
+                idle.wait(lock, [this]{ return (dead.empty() && !busy) || !worker.joinable(); });
+        }
+
+private:
+        SurrogateReclaimer(const SurrogateReclaimer &);
+        SurrogateReclaimer &operator=(const SurrogateReclaimer &);
+
+        enum { SLICE = 4096 };  // 后台线程每次持锁取出的对象数
+
+        void run() {
+                std::unique_lock<std::mutex> lock(m);
+                for (;;) {
+                        cv.wait(lock, [this]{ return stopping || !dead.empty(); });
+                        if (dead.empty()) 
+                                return;
+                        busy = true;
+                        lock.unlock();
+                        reclaim(SLICE);
+                        lock.lock();
+                        busy = false;
+                        if (dead.empty())
+                                idle.notify_all();
+                }
+        }
+
+        std::mutex m;
+        std::condition_variable cv, idle;
+        std::deque<Super *> dead;
+        bool stopping;
+        bool busy;
+        std::thread worker;
+};
+
+#endif
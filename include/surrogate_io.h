@@ -0,0 +1,291 @@
+#ifndef SURROGATE_IO_H
+#define SURROGATE_IO_H
+
+#include <cstddef>
+#include <istream>
+#include <new>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#include "surrogate.h"
+
+// vector<Surrogate>的二进制存储
+// 格式(整数均为小端)：
+//     "SRG1"
+//     u32 类型数k，之后k个类型名(u8长度 + 名字)，名字在SurrogateRegistry中注册
+//     u32 对象数n，之后n个u8：0表示空的Surrogate，i表示上面的第i个类型
+// 文件中保存的是类型名而不是本进程中的编号，所以注册的顺序可以改变。
+// 只保存类型，所以每个对象只占一个字节；有数据成员的类型会丢失状态，不能注册。
+//
+// 逐个用clone()重建n个对象要分配n次。read_surrogates可以先读出所有类型编号，
+// 算出需要的总字节数，在SurrogateArena中一次分配好，再把对象逐个构造在其中；
+// 得到的Surrogate只是借用这些对象，不能比SurrogateArena活得更久。
+
+// 类型注册表：类型名 <-> 大小、对齐与构造函数。add不是线程安全的，应在启动时完成注册
+class SurrogateRegistry{
+public:
+        struct Type{
+                std::string name;
+                unsigned size, align;
+                Super *(*create)();             // 在堆上构造
+                Super *(*construct)(void *);    // 在给定的位置构造
+        };
+
+        static SurrogateRegistry &instance() {
+                static SurrogateRegistry r;
+                return r;
+        }
+
+        // T须可以默认构造，不能有数据成员(大小与Super相同)，
+        // 对齐要求不超过std::max_align_t(create用new在堆上构造)；
+        // 重复注册同一个名字时替换原来的类型
+        template<typename T>
+        void add(const std::string &name) {
+                static_assert(sizeof(T)==sizeof(Super),
+                              "only the type is stored, so Surrogate types cannot have data members");
+                static_assert(alignof(T)<=alignof(std::max_align_t),
+                              "new does not honour over-aligned Surrogate types");
+                if (name.empty() || name.size()>255)
+                        throw "bad Surrogate type name.";
+                Type t = {name, sizeof(T), alignof(T), &create<T>, &construct<T>};
+                std::unordered_map<std::string, unsigned>::iterator it = by_name.find(name);
+                unsigned id;
+                if (it!=by_name.end()) {
+                        id = it->second;
+                        types[id] = t;
+                } else {
+                        if (types.size()==255)
+                                throw "too many Surrogate types.";
+                        id = types.size();
+                        types.push_back(t);
+                        by_name[name] = id;
+                }
+                by_type[std::type_index(typeid(T))] = id;
+        }
+
+        unsigned size() const {return types.size();}
+        const Type &operator[](unsigned id) const {
+                if (id>=types.size())
+                        throw "SurrogateRegistry subscript out of range.";
+                return types[id];
+        }
+
+        // 对象的动态类型对应的编号
+        unsigned id(const Super &s) const {
+                std::unordered_map<std::type_index, unsigned>::const_iterator it =
+                        by_type.find(std::type_index(typeid(s)));
+                if (it==by_type.end())
+                        throw "unregistered Surrogate type.";
+                return it->second;
+        }
+        unsigned id(const std::string &name) const {
+                std::unordered_map<std::string, unsigned>::const_iterator it = by_name.find(name);
+                if (it==by_name.end())
+                        throw "unregistered Surrogate type.";
+                return it->second;
+        }
+
+private:
+        SurrogateRegistry() {
+                add<Super>("Super");
+                add<Sub1>("Sub1");
+                add<Sub2>("Sub2");
+        }
+        SurrogateRegistry(const SurrogateRegistry &);
+        SurrogateRegistry &operator=(const SurrogateRegistry &);
+
+        template<typename T>
+        static Super *create() {return new T;}
+        template<typename T>
+        static Super *construct(void *at) {return new(at) T;}
+
+        std::vector<Type> types;
+        std::unordered_map<std::string, unsigned> by_name;
+        std::unordered_map<std::type_index, unsigned> by_type;
+};
+
+// 在连续的内存块中构造对象，析构时一起析构并释放。
+// 从这里借用对象的Surrogate必须先于SurrogateArena销毁。
+class SurrogateArena{
+public:
+        SurrogateArena():used(0), capacity(0) {}
+        ~SurrogateArena() {
+                for (unsigned i=0; i!=objects.size(); i++)
+                        objects[i]->~Super();
+                for (unsigned i=0; i!=blocks.size(); i++)
+                        ::operator delete(blocks[i]);
+        }
+
+        // 保证接下来的bytes个字节、count个对象不再分配
+        void reserve(std::size_t bytes, unsigned count=0) {
+                objects.reserve(objects.size()+count);
+                if (blocks.empty() || used+bytes>capacity) {
+                        blocks.push_back(static_cast<char *>(::operator new(bytes ? bytes : 1)));
+                        capacity = bytes;
+                        used = 0;
+                }
+        }
+
+        // 用注册表中的第id个类型构造一个对象
+        Super *construct(unsigned id) {
+                return construct(SurrogateRegistry::instance()[id]);
+        }
+        Super *construct(const SurrogateRegistry::Type &t) {
+                std::size_t at = offset(t.align);
+                if (blocks.empty() || at+t.size>capacity) {
+                        reserve(t.size + t.align);
+                        at = offset(t.align);
+                }
+                Super *p = t.construct(blocks.back()+at);
+                used = at+t.size;
+                objects.push_back(p);
+                return p;
+        }
+
+        unsigned size() const {return objects.size();}
+
+        static std::size_t align(std::size_t n, std::size_t a) {return (n+a-1)/a*a;}
+
+private:
+        // 最后一个块中第一个按a对齐的地址在块中的位置(不早于used)
+        std::size_t offset(std::size_t a) const {
+                if (blocks.empty()) return 0;
+                std::size_t base = reinterpret_cast<std::size_t>(blocks.back());
+                return align(base+used, a) - base;
+        }
+
+        SurrogateArena(const SurrogateArena &);
+        SurrogateArena &operator=(const SurrogateArena &);
+
+        std::vector<char *> blocks;
+        std::size_t used, capacity;     // 最后一个块中已用的字节数与块的大小
+        std::vector<Super *> objects;
+};
+
+namespace surrogate_io {
+
+inline void put32(std::string &buf, unsigned v) {
+        for (int i=0; i!=4; i++)
+                buf += char((v >> 8*i) & 0xff);
+}
+
+inline unsigned get32(std::istream &in) {
+        unsigned char b[4];
+        if (!in.read(reinterpret_cast<char *>(b), 4))
+                throw "bad Surrogate stream.";
+        return b[0] | b[1] << 8 | b[2] << 16 | unsigned(b[3]) << 24;
+}
+
+// 读出文件头与全部类型编号，编号换成本进程注册表中的编号，0xff表示空的Surrogate
+inline std::vector<unsigned char> read_ids(std::istream &in) {
+        char magic[4];
+        if (!in.read(magic, 4) || std::string(magic, 4)!="SRG1")
+                throw "bad Surrogate stream.";
+        const SurrogateRegistry &reg = SurrogateRegistry::instance();
+        unsigned k = get32(in);
+        if (k>255)
+                throw "bad Surrogate stream.";
+        unsigned char map[256];
+        map[0] = 0xff;
+        for (unsigned i=1; i<=k; i++) {
+                char name[256];
+                int len = in.get();
+                if (len==EOF || !in.read(name, len))
+                        throw "bad Surrogate stream.";
+                map[i] = (unsigned char)reg.id(std::string(name, len));
+        }
+        unsigned n = get32(in);
+        std::vector<unsigned char> ids(n);
+        if (n && !in.read(reinterpret_cast<char *>(&ids[0]), n))
+                throw "bad Surrogate stream.";
+        for (unsigned i=0; i!=n; i++) {
+                if (ids[i]>k)
+                        throw "bad Surrogate stream.";
+                ids[i] = map[ids[i]];
+        }
+        return ids;
+}
+
+}
+
+inline void write_surrogates(std::ostream &out, const std::vector<Surrogate> &v) {
+        const SurrogateRegistry &reg = SurrogateRegistry::instance();
+        // 只写出实际出现过的类型
+        unsigned char local[256] = {0};
+        std::vector<unsigned> used;
+        const std::type_info *last = 0;
+        unsigned last_id = 0;
+        std::string body;
+        body.reserve(v.size());
+        for (unsigned i=0; i!=v.size(); i++) {
+                Super *p = const_cast<Surrogate &>(v[i]).get();
+                if (!p) {
+                        body += char(0);
+                        continue;
+                }
+                // 相邻的对象往往类型相同，先与上一个比较，省去一次散列查找
+                const std::type_info &ti = typeid(*p);
+                if (!last || ti!=*last) {
+                        last = &ti;
+                        last_id = reg.id(*p);
+                }
+                unsigned id = last_id;
+                if (!local[id]) {
+                        used.push_back(id);
+                        local[id] = (unsigned char)used.size();
+                }
+                body += char(local[id]);
+        }
+        std::string head("SRG1");
+        surrogate_io::put32(head, used.size());
+        for (unsigned i=0; i!=used.size(); i++) {
+                const std::string &name = reg[used[i]].name;
+                head += char(name.size());
+                head += name;
+        }
+        surrogate_io::put32(head, v.size());
+        out.write(head.data(), head.size());
+        out.write(body.data(), body.size());
+        if (!out)
+                throw "cannot write Surrogate stream.";
+}
+
+// 追加到v的末尾，每个对象单独在堆上分配，得到的Surrogate独占其对象
+inline void read_surrogates(std::istream &in, std::vector<Surrogate> &v) {
+        std::vector<unsigned char> ids = surrogate_io::read_ids(in);
+        const SurrogateRegistry &reg = SurrogateRegistry::instance();
+        unsigned base = v.size();
+        v.resize(base + ids.size());
+        for (unsigned i=0; i!=ids.size(); i++)
+                if (ids[i]!=0xff)
+                        v[base+i].reset(reg[ids[i]].create());
+}
+
+// 追加到v的末尾，所有对象都构造在arena的一块内存中，得到的Surrogate借用这些对象
+inline void read_surrogates(std::istream &in, std::vector<Surrogate> &v, SurrogateArena &arena) {
+        std::vector<unsigned char> ids = surrogate_io::read_ids(in);
+        const SurrogateRegistry &reg = SurrogateRegistry::instance();
+        const SurrogateRegistry::Type *types[256];
+        for (unsigned i=0; i!=reg.size(); i++)
+                types[i] = &reg[i];
+        std::size_t bytes = 0, most = 1;
+        unsigned count = 0;
+        for (unsigned i=0; i!=ids.size(); i++)
+                if (ids[i]!=0xff) {
+                        const SurrogateRegistry::Type &t = *types[ids[i]];
+                        bytes = SurrogateArena::align(bytes, t.align) + t.size;
+                        if (t.align>most) most = t.align;
+                        count++;
+                }
+        arena.reserve(bytes + most, count);     // 起点可能还需要对齐
+        unsigned base = v.size();
+        v.resize(base + ids.size());
+        for (unsigned i=0; i!=ids.size(); i++)
+                if (ids[i]!=0xff)
+                        v[base+i].reset(arena.construct(*types[ids[i]]), false);
+}
+
+#endif
@@ -1,53 +1,9 @@
 #include <iostream>
 #include <vector>
+#include <cassert>
+#include "surrogate.h"
 using namespace std;
 
-// 继承树
-class Super{
-public:
-    virtual void f() {cout << "f() in super ."<< endl;}
-    virtual Super* clone()const {return new Super();}
-};
-class Sub1:public Super{
-public:
-    virtual void f() {cout << "f() in sub1 ."<< endl;}
-    virtual Super* clone()const {return new Sub1();}
-};
-class Sub2:public Super{
-public:
-    virtual void f() {cout << "f() in sub2 ."<< endl;}
-    virtual Super* clone()const {return new Sub2();}
-};
-
-
-// 代理类
-class Surrogate{
-public:
-        Surrogate():p(0) {}   
-        Surrogate(const Super&s):p(s.clone()) {}
-        Surrogate(const Surrogate&s):p(s.p?s.p->clone():0) {}
-        Surrogate &operator=(const Surrogate &s){
-                if (this!=&s) {
-                        delete p;
-                        p = s.p->clone();
-                }
-                return *this;
-        }
-        ~Surrogate(){delete p;}
-
-
-        void f() {return p->f();} //
-
-        Super * operator->(){return p;} // C++ 重载 ‘->’ 操作符！
-        Super & operator*(){return *p;} // C++ 重载 ‘*’ 操作符！
-
-        Super *get(){return p;}
-        //Super &get(){return *p;}
-
-private:
-        Super *p;            
-};
-
 int main()
 {
 	vector<Surrogate> v;
@@ -71,7 +27,11 @@ int main()
 	v[2].get()->f();
 	cout << endl;	
 
+	instrument::reset();
 	vector<Surrogate> v1=v;
+	if (instrument::enabled)
+		assert(instrument::snapshot()[instrument::SUPER_CLONE]==3);
+	cout << instrument::snapshot().to_json() << endl;
 	v.erase(v.begin(), v.end());
 	v1[0].f();
 	v1[1].f();
@@ -86,5 +46,21 @@ int main()
 	v2[2].f();
 	cout << endl;	
 
+	// 把大量对象交给后台线程释放
+	SurrogateReclaimer bg;
+	vector<Surrogate> v3(100000, Surrogate(Sub1()));
+	bg.retire(v3);
+	assert(v3.empty());
+	bg.drain();
+	assert(bg.pending()==0);
+
+	// 分多次在当前线程释放
+	SurrogateReclaimer inc(false);
+	vector<Surrogate> v4(10000, Surrogate(Sub2()));
+	v4.push_back(Surrogate());
+	inc.retire(v4);
+	assert(inc.pending()==10000);
+	assert(inc.reclaim(4000)==4000 && inc.pending()==6000);
+
 	return 0;
 }
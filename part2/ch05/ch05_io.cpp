@@ -0,0 +1,127 @@
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+#include <cassert>
+#include "surrogate_io.h"
+using namespace std;
+
+class Sub3:public Super{
+public:
+	virtual void f() {cout << "f() in sub3 ." << endl;}
+	virtual Super* clone()const {INSTRUMENT_COUNT(SUPER_CLONE, 1); return new Sub3();}
+};
+// 有数据成员或者对齐要求超过max_align_t的子类，add<T>()不能通过编译
+class Unregistered:public Super{
+public:
+	virtual Super* clone()const {return new Unregistered();}
+};
+
+// 两组Surrogate所代理的对象类型是否相同
+static bool same_types(vector<Surrogate> &a, vector<Surrogate> &b)
+{
+	if (a.size()!=b.size()) return false;
+	for (unsigned i=0; i!=a.size(); i++) {
+		if (!a[i].get() || !b[i].get()) {
+			if (a[i].get()!=b[i].get()) return false;
+		} else if (typeid(*a[i])!=typeid(*b[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main()
+{
+	SurrogateRegistry::instance().add<Sub3>("Sub3");
+
+	vector<Surrogate> v;
+	for (unsigned i=0; i!=1000; i++) {
+		switch (i%5) {
+		case 0: v.push_back(Super()); break;
+		case 1: v.push_back(Sub1()); break;
+		case 2: v.push_back(Sub2()); break;
+		case 3: v.push_back(Sub3()); break;
+		case 4: v.push_back(Surrogate()); break;
+		}
+	}
+	ostringstream os;
+	write_surrogates(os, v);
+	const string bytes = os.str();
+	assert(bytes.size() < v.size() + 40);   // 每个对象一个字节
+	cout << v.size() << " surrogates in " << bytes.size() << " bytes" << endl;
+
+	// 每个对象单独分配，独占
+	{
+		vector<Surrogate> h;
+		istringstream is(bytes);
+		read_surrogates(is, h);
+		assert(same_types(v, h));
+		assert(h[1].owns() && h[4].get()==0);
+		h[2].f();
+		h[3].f();
+		assert(typeid(*h[3])==typeid(Sub3));
+	}
+
+	// 所有对象都在arena中，不调用clone
+	SurrogateArena arena;
+	{
+		instrument::reset();
+		vector<Surrogate> a;
+		istringstream is(bytes);
+		read_surrogates(is, a, arena);
+		if (instrument::enabled)
+			assert(instrument::snapshot()[instrument::SUPER_CLONE]==0);
+		assert(same_types(v, a));
+		assert(arena.size()==800);
+		assert(!a[0].owns() && !a[3].owns());
+		assert(reinterpret_cast<size_t>(a[3].get()) % alignof(Sub3) == 0);
+		a[3].f();
+
+		// 复制借用的Surrogate得到独占的副本
+		Surrogate c = a[1];
+		assert(c.owns() && c.get()!=a[1].get());
+		c = a[3];
+		assert(c.owns() && typeid(*c)==typeid(Sub3));
+
+		// release借用的对象返回一个克隆，由调用者释放
+		Super *r = a[2].release();
+		assert(r && a[2].get()==0 && typeid(*r)==typeid(Sub2));
+		delete r;
+
+		// SurrogateReclaimer只接管独占的对象
+		a.push_back(Sub1());
+		SurrogateReclaimer inc(false);
+		inc.retire(a);
+		assert(a.empty() && inc.pending()==1);
+	}
+
+	// 同一个arena可以继续读入
+	{
+		vector<Surrogate> a;
+		istringstream is(bytes);
+		read_surrogates(is, a, arena);
+		assert(arena.size()==1600 && same_types(v, a));
+	}
+
+	// 写出未注册的类型，读入损坏的数据
+	try {
+		vector<Surrogate> u(1, Surrogate(Unregistered()));
+		ostringstream o;
+		write_surrogates(o, u);
+		assert(false);
+	} catch (const char *e) {
+		cout << e << endl;
+	}
+	try {
+		vector<Surrogate> t;
+		istringstream is(bytes.substr(0, bytes.size()/2));
+		read_surrogates(is, t);
+		assert(false);
+	} catch (const char *e) {
+		cout << e << endl;
+	}
+
+	cout << " --- OK." << endl;
+	return 0;
+}
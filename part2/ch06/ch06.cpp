@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include "handle.h"
+using namespace std;
+
+// 复制时抛出异常的对象
+class NoClone:public Super{
+public:
+	NoClone(bool ok=true):ok(ok) {}
+	virtual Super* clone()const {
+		if (!ok) throw "NoClone cannot be cloned.";
+		return new NoClone(false);
+	}
+	bool ok;
+};
+
+int main()
+{
+	vector<Handle> v;
+	v.push_back(Super());
+	v.push_back(Sub1());
+	v.push_back(Sub2());
+	assert(v[0].unique() && v[1].unique() && v[2].unique());
+
+	// 复制句柄只增加引用计数，不克隆对象
+	instrument::reset();
+	vector<Handle> v1 = v;
+	if (instrument::enabled)
+		assert(instrument::snapshot()[instrument::SUPER_CLONE]==0);
+	const vector<Handle> &cv = v, &cv1 = v1;
+	assert(v[1].use_count()==2 && cv1[1].get()==cv[1].get());
+
+	// 通过const句柄只读访问，仍然共享
+	const Handle &ch = v1[2];
+	const Super *shared = ch.get();
+	assert(shared==ch.operator->() && v1[2].use_count()==2);
+
+	// 通过非const句柄访问，先复制一份
+	v1[2].f();
+	assert(v1[2].unique() && v[2].unique());
+	assert(cv1[2].get()!=cv[2].get());
+
+	// 赋值与自赋值
+	Handle h;
+	assert(h.use_count()==0);
+	h = v[0];
+	assert(v[0].use_count()==3);
+	h = h;
+	assert(h.use_count()==3);
+	v.clear();
+	v1.clear();
+	assert(h.unique());
+	h->f();
+
+	// 写时复制失败时，两个句柄仍然共享原来的对象
+	Handle n1(NoClone(true));   // 构造时的克隆成功，得到的对象不能再复制
+	Handle n2 = n1;
+	try {
+		n2.f();
+		assert(false);
+	} catch (const char *) {
+	}
+	assert(n1.use_count()==2 && n2.use_count()==2);
+	const Handle &cn1 = n1, &cn2 = n2;
+	assert(cn1.get()==cn2.get());
+
+	cout << " --- OK." << endl;
+	return 0;
+}
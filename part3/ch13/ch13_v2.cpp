@@ -13,7 +13,7 @@ class ArrayData{
     friend class Pointer<T>;
     friend class Array<T>;
 
-    ArrayData(unsigned n=0):size(n),data(new T[size]),used(1){}
+    ArrayData(unsigned n=0):size(n),data(new T[size]()),used(1){}   // 元素值初始化，int为0
     ~ArrayData(){delete[] data;}
 
     // 声明而不定义，禁止拷贝和赋值操作
@@ -132,5 +132,6 @@ int main()
     // 间接引用
     pua->greeting();
 
+    delete pp;
     return 0;
 }
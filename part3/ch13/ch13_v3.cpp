@@ -17,7 +17,7 @@ class ArrayData{
     friend class Ptr_to_const<T>;
     friend class Array<T>;
 
-    ArrayData(unsigned n=0):size(n),data(new T[size]),used(1){}
+    ArrayData(unsigned n=0):size(n),data(new T[size]()),used(1){}   // 元素值初始化，int为0
     ~ArrayData(){delete[] data;}
 
     // 声明而不定义，禁止拷贝和赋值操作
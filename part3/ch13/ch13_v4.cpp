@@ -20,7 +20,7 @@ class ArrayData{
     ArrayData(unsigned n=0):sz(n),data(new T[sz]),used(1){}
     ~ArrayData(){delete[] data;}
 
-    ArrayData(const ArrayData& a):sz(a.sz),data(new T[sz], used(1)) {
+    ArrayData(const ArrayData& a):sz(a.sz),data(new T[sz]), used(1) {
        copy(a.data,sz);
     }
 
@@ -1,267 +1,9 @@
 #include <iostream>
 #include <cassert>
+#include "array.h"
 
 using namespace std;
 
-template<typename T>
-class Ptr_to_const;
-template<typename T>
-class Pointer;
-template <typename T>
-class Array;
-
-// 数组实现类
-template <typename T>
-class ArrayData{
-    friend class Pointer<T>;
-    friend class Ptr_to_const<T>;
-    friend class Array<T>;
-
-    ArrayData(unsigned n=0):sz(n),data(new T[sz]),used(1){}
-    ~ArrayData(){delete[] data;}
-
-    ArrayData(const ArrayData& a):sz(a.sz),data(new T[sz], used(1)) {
-       copy(a.data,sz);
-    }
-
-    void clone(const ArrayData &a , unsigned s) {
-
-        if (s!=sz) {
-            T *ndata=new T[s];
-            sz = s;
-            delete []data;
-            data=ndata;
-        }
-        copy(a.data, sz);
-    }
-
-    ArrayData &operator=(const ArrayData &);
-
-    // 支持下标操作(考虑const的情况)
-    const T& operator[](unsigned i) const{
-        if (i>=sz || 0==data) 
-            throw "ArrayData subscript out of range.";
-        return data[i];
-    }
-    // 'effective C++ 条款3:尽可能使用const' 里提到的技巧
-    T& operator[](unsigned i){
-        return const_cast<T &>(static_cast<const ArrayData &>(*this)[i]);
-    }
-    
-    void copy(T *d, unsigned s) {
-        for (int i=0; i!=s; i++) {
-            data[i] = d[i];
-        }
-    }   
-
-    unsigned min(unsigned a, unsigned b) {
-        return a<b?a:b; 
-    }
-
-    void resize(unsigned news) {
-        if (news==sz) return;
-
-        // 考虑异常安全性
-        T *nd = new T[news]; 
-        T *tmp = data;
-        data = nd;
-        copy(tmp, min(sz,news));
-        sz = news;
-        delete [] tmp;
-    }
-
-    void reserve(unsigned s) {
-        if (s<sz) return ;
-
-        unsigned news = sz;
-        if (news==0) news = 1;
-
-        while (news<=s) { // 这里不是news<s
-            news *= 2;
-        }
-        resize(news);
-    }
-    
-    unsigned size() const {
-        return sz;
-    }
-
-    unsigned sz;
-    T *data;
-
-    int used;
-};
-
-// 数组封装类
-template <typename T>
-class Array{
-public:
-    friend class Pointer<T>;
-    friend class Ptr_to_const<T>;
-
-    Array(unsigned n=0):pa(new ArrayData<T>(n)){}
-    ~Array(){if(--pa->used==0)delete pa;}
-
-    Array(const Array& a):pa(new ArrayData<T>(*(a.pa))) {}
-
-    Array &operator=(const Array &a) {
-        if (this != &a)
-            pa->clone(*(a.pa), a.size());
-        return *this;
-    }
-    
-    // 支持下标操作(考虑const的情况)
-    const T& operator[](unsigned i) const{
-        return (*pa)[i];
-    }
-    // 'effective C++ 条款3:尽可能使用const' 里提到的技巧
-    T& operator[](unsigned i){
-        return const_cast<T &>(static_cast<const Array &>(*this)[i]);
-    }
-    
-    void resize(unsigned s)
-    {
-       pa->resize(s);
-    }
-
-    void reserve(unsigned s) 
-    {
-        pa->reserve(s);
-    }
-
-    unsigned size()const
-    {
-        return pa->size();
-    }
-private:
-    
-    ArrayData<T> *pa;
-};
-
-// 指向const Array的指针类
-template<typename T>
-class Ptr_to_const{
-friend bool operator==(const Ptr_to_const &lhs, const Ptr_to_const &rhs);
-friend bool operator!=(const Ptr_to_const &lhs, const Ptr_to_const &rhs);
-friend int operator-(const Ptr_to_const &lhs, const Ptr_to_const &rhs); 
-
-public:
-    Ptr_to_const():pa(0),index(0){}
-    Ptr_to_const(const Array<T>& a, unsigned i=0):pa(a.pa),index(i){pa->used++;}
-    ~Ptr_to_const(){if(pa&&--pa->used==0)delete pa;}
-    Ptr_to_const(const Ptr_to_const &p):pa(p.pa?p.pa:0), index(p.index) {
-            if(pa)pa->used++;}
-    Ptr_to_const &operator=(const Ptr_to_const &p){
-        if (p.pa) p.pa->used++;
-        if (pa && --pa->used==0) delete pa;
-        pa = p.pa;
-        index = p.index;
-        return *this;
-    }
-    
-    // 返回值均为const 类型
-    const T* operator->() const {
-        if (0==pa)throw "-> of unbound Pointer";
-        else return &((*pa)[index]);
-    }
-    const T& operator*() const {
-        if (0==pa)throw "* of unbound Pointer";
-        else return ((*pa)[index]);
-    }
-
-    // 完善Ptr_to_const类的++ -- != 及==操作
-    Ptr_to_const& operator++() {
-        index++;
-        return *this;
-    }
-
-    Ptr_to_const operator++(int){
-        Ptr_to_const tmp(*this);  
-        ++(*this); 
-        return tmp;
-    }
-
-    Ptr_to_const& operator--() {
-        index--;
-        return *this;
-    }
-
-    Ptr_to_const operator--(int){
-        Ptr_to_const tmp(*this);  
-        ++(*this); 
-        return tmp;
-    } 
-
-//这里必须是protected的了
-protected:
-    ArrayData<T> *pa;
-    unsigned index;
-};
-// 指向 Array的指针类
-template<typename T>
-class Pointer:public Ptr_to_const<T>{
-public:
-    Pointer(Array<T> &a, unsigned i=0):Ptr_to_const<T>(a,i) {}
-    Pointer() {}
-    // 注意，这里使用了基于作用域的名称掩盖规则，返回值均为非const 类型
-    // 在'effective c++的条款36中说：绝不重新定义继承而来的non-virtual函数， 但我们却这么做了'
-    // 这里为什么要用using，参考'effective c++的条款43:学习处理模板化基类内的名称'
-    using Ptr_to_const<T>::pa;
-    using Ptr_to_const<T>::index;
-    T* operator->() const {
-        if (0==pa)throw "-> of unbound Pointer";
-        else return &((*pa)[index]);
-    }
-    T& operator*() const {
-        if (0==pa)throw "* of unbound Pointer";
-        else return ((*pa)[index]);
-    }
-
-
-    // 完善Pointer类的++ -- != 及==操作
-    Pointer& operator++() {
-        index++;
-        return *this;
-    }
-
-    Pointer operator++(int){
-        Pointer tmp(*this);  
-        ++(*this); 
-        return tmp;
-    }
-
-    Pointer& operator--() {
-        index--;
-        return *this;
-    }
-
-    Pointer operator--(int){
-        Pointer tmp(*this);  
-        ++(*this); 
-        return tmp;
-    } 
-
-    
-};
-
-
-template<typename T>
-int operator-(const Ptr_to_const<T> &lhs, const Ptr_to_const<T> &rhs) {
-    if (lhs.pa!=rhs.pa)
-        throw "";
-    return lhs.index-rhs.index;
-}
-
-template<typename T>
-bool operator==(const Ptr_to_const<T> &lhs, const Ptr_to_const<T> &rhs) {
-    return (lhs.pa==rhs.pa && lhs.index==rhs.index);
-}
-
-template<typename T>
-bool operator!=(const Ptr_to_const<T> &lhs, const Ptr_to_const<T> &rhs) {
-    return !(lhs == rhs);
-}
-
 int main()
 {
     Array<int> a(10);
@@ -279,7 +21,9 @@ int main()
     
     i=9;
     do{
-        assert(*(--pend)==i--);
+        --pend;
+        assert(*pend==i);
+        i--;
     } while (pend==pstart);
 
     Array<int> b(10);
@@ -289,6 +33,17 @@ int main()
     Pointer<int> p4(b, 0);
     assert(p1==p2 && p1!=p3 && p1!=p4);
 
+    // 计数器(编译时定义了RUMINATIONS_INSTRUMENT才计数)
+    instrument::reset();
+    Array<int> c(10);
+    Pointer<int> pc(c, 0);
+    c.resize(20);
+    instrument::Snapshot st = instrument::snapshot();
+    if (instrument::enabled)
+        assert(st[instrument::ARRAY_RESIZE]==1 && st[instrument::ARRAY_COPY]==10
+                && st[instrument::ARRAY_COPY_BYTES]==10*sizeof(int) && st[instrument::REFCOUNT_INC]==1);
+    std::cout << st.to_json() << std::endl;
+
     std::cout << " --- OK." << std::endl;
     return 0;
 }
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <cassert>
+#include "array_expr.h"
+
+using namespace std;
+
+int main()
+{
+    Array<double> a(100), b(100), c(100);
+    unsigned i;
+    for (i=0; i!=100; i++) {
+        a[i] = i;
+        b[i] = 2*i;
+    }
+
+    // 一个循环计算整个表达式
+    c = a + b * 0.5;
+    for (i=0; i!=100; i++)
+        assert(c[i]==2*i);
+
+    c = (a - b) / 2.0 + 1.0;
+    assert(c[10]==-4);
+    c = -a * 2.0;
+    assert(c[3]==-6);
+    c = 3.0 * a - b;
+    assert(c[7]==7);
+
+    // 目标也可以出现在表达式中
+    c = c + c;
+    assert(c[7]==14);
+
+    // 由表达式构造，或者赋值给长度不同的Array
+    Array<double> d = a * a;
+    assert(d.size()==100 && d[9]==81);
+    Array<double> e;
+    e = a + 1.0;
+    assert(e.size()==100 && e[99]==100);
+
+    // 长度不同的Array不能一起运算
+    bool thrown = false;
+    Array<double> f(10);
+    try {
+        c = a + f;
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 空的Array不是标量，也不能与长度不同的Array一起运算
+    Array<double> z(0);
+    thrown = false;
+    try {
+        c = z + a;
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        c = a * 2.0 - z;
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+    c = z + z * 2.0;
+    assert(c.size()==0);
+
+    // 普通的赋值仍然复制元素
+    Array<int> g(5), h(5);
+    for (i=0; i!=5; i++)
+        g[i] = 0;
+    g[1] = 3;
+    h = g;
+    g = g * 2 + h;
+    assert(g[1]==9 && h[1]==3);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cassert>
+#include <type_traits>
+#include "fixed_array.h"
+
+using namespace std;
+
+constexpr unsigned square(unsigned i) {return i*i;}
+constexpr unsigned add(unsigned a, unsigned b) {return a+b;}
+
+// 编译时建好的查找表：每个字节中1的个数
+struct Popcount {
+    constexpr unsigned char operator()(unsigned i) const {
+        return i ? (i&1) + (*this)(i>>1) : 0;
+    }
+};
+constexpr Array<unsigned char, 256> popcount_table = generate<unsigned char, 256>(Popcount());
+
+constexpr Array<unsigned, 16> squares = generate<unsigned, 16>(square);
+static_assert(squares[15]==225 && squares.at<3>()==9 && squares.at(4)==16, "squares");
+static_assert(fold(squares, 0u, add)==1240, "sum of squares");
+static_assert(popcount_table[0xff]==8 && popcount_table[0x35]==4, "popcount");
+
+constexpr Array<int, 5> unsorted(4, -1, 3, 0, 2);
+constexpr Array<int, 5> ordered = sorted(unsorted);
+static_assert(ordered==Array<int, 5>(-1, 0, 2, 3, 4), "sorted");
+static_assert(find(ordered, 3)==3 && find(ordered, 7)==5, "find");
+// squares[16]或squares.at<16>()在这里都不能通过编译
+
+int main()
+{
+    // 未列出的元素为T()；构造函数是explicit的，Array<int, 4> a = 1;不能通过编译
+    Array<int, 4> a(1, 2);
+    assert(a[0]==1 && a[1]==2 && a[2]==0 && a[3]==0);
+    static_assert(!std::is_convertible<int, Array<int, 4> >::value, "explicit");
+    static_assert(sizeof(a)==4*sizeof(int), "no heap, no count");
+
+    // at(i)在运行时检查边界
+    assert(a.at(1)==2);
+    bool thrown = false;
+    try {
+        a.at(4);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 内置指针就是它的Pointer
+    int sum = 0;
+    for (const int *p=a.begin(); p!=a.end(); ++p)
+        sum += *p;
+    assert(sum==3 && a.end()-a.begin()==4);
+    fill(a, 7);
+    assert(a[3]==7);
+
+    // 与Array<T>互相转换
+    Array<int> d = a.dynamic();
+    assert(d.size()==4 && d[2]==7);
+    d[2] = 9;
+    Array<int, 4> b(d);
+    assert(b[2]==9 && b!=a);
+
+    unsigned bits = 0;
+    for (unsigned i=0; i!=256; i++)
+        bits += popcount_table[i];
+    assert(bits==1024);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+#include "array_loader.h"
+
+using namespace std;
+
+// 用两种方式读入同一个文件，检查内容与回调覆盖的范围
+static void check(ArrayLoader::Backend b, const char *path, unsigned n)
+{
+    ArrayLoader loader(b, 4, 3);
+    if (b!=ArrayLoader::AUTO)
+        assert(loader.backend()==b);
+    Array<int> a;
+    vector<int> seen(n, 0);
+    long sum = 0;
+    loader.load(path, a, 1000, [&](unsigned begin, unsigned end) {
+        assert(begin<end && end<=n && (end-begin==1000 || end==n));
+        for (unsigned i=begin; i!=end; i++) {
+            seen[i]++;
+            sum += a[i];
+        }
+    });
+    assert(a.size()==n);
+    for (unsigned i=0; i!=n; i++)
+        assert(a[i]==int(i*3) && seen[i]==1);
+    assert(sum==3L*n*(n-1)/2);
+
+    // 不逐块处理
+    Array<int> b2;
+    loader.load(path, b2);
+    assert(b2.size()==n && b2[n-1]==int((n-1)*3));
+}
+
+int main()
+{
+    char path[] = "/tmp/ch14_loaderXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd>=0);
+    const unsigned n = 123457;
+    vector<int> v(n);
+    for (unsigned i=0; i!=n; i++)
+        v[i] = i*3;
+    ssize_t written = write(fd, &v[0], n*sizeof(int));
+    assert(written==ssize_t(n*sizeof(int)));
+    close(fd);
+
+    check(ArrayLoader::THREADS, path, n);
+    check(ArrayLoader::AUTO, path, n);
+    ArrayLoader loader;
+    cout << (loader.backend()==ArrayLoader::URING ? "io_uring" : "threads") << endl;
+
+    // 出错
+    bool thrown = false;
+    try {
+        Array<int> a;
+        loader.load("/nonexistent/file", a);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 回调抛出的异常传给调用者，进行中的读请求先结束
+    thrown = false;
+    try {
+        Array<int> a;
+        loader.load(path, a, 100, [](unsigned, unsigned) { throw 1; });
+    } catch (int) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 读线程在回调抛出异常之后仍然可以用于下一次load
+    ArrayLoader pooled(ArrayLoader::THREADS, 4, 3);
+    thrown = false;
+    try {
+        Array<int> a;
+        pooled.load(path, a, 100, [](unsigned, unsigned) { throw 1; });
+    } catch (int) {
+        thrown = true;
+    }
+    assert(thrown);
+    Array<int> c;
+    pooled.load(path, c);
+    assert(c.size()==n && c[n-1]==int((n-1)*3));
+
+    remove(path);
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
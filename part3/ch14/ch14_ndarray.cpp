@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include "ndarray.h"
+
+using namespace std;
+
+int main()
+{
+    // 行优先的3x4数组
+    NDArray<int, 2> a(3, 4);
+    assert(a.size()==12 && a.shape(0)==3 && a.shape(1)==4);
+    int i, j;
+    for (i=0; i!=3; i++)
+        for (j=0; j!=4; j++)
+            a(i, j) = i*10+j;
+    assert(a.view().data()[5]==11);   // 同一行的元素相邻
+
+    // 越界访问
+    bool thrown = false;
+    try {
+        a(3, 0);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 列优先
+    unsigned shape[2] = {3, 4};
+    NDArray<int, 2> c(shape, COL_MAJOR);
+    for (i=0; i!=3; i++)
+        for (j=0; j!=4; j++)
+            c(i, j) = a(i, j);
+    assert(c.view().data()[1]==10);   // 同一列的元素相邻
+
+    // 切片与固定下标都不复制元素
+    NDView<int, 2> s = a.view().slice(0, 1, 3).slice(1, 2, 4);
+    assert(s.shape(0)==2 && s.shape(1)==2 && s(0, 0)==12 && s(1, 1)==23);
+    s(0, 0) = -1;
+    assert(a(1, 2)==-1);
+    a(1, 2) = 12;
+    NDView<int, 1> col = a.view().fix(1, 3);
+    assert(col.shape(0)==3 && col(2)==23);
+
+    // 转置视图
+    NDView<const int, 2> t = static_cast<const NDArray<int, 2>&>(a).view().transposed();
+    assert(t.shape(0)==4 && t(3, 1)==13);
+
+    // for_each 按内存顺序访问，行优先与列优先的结果相同
+    long sa = 0, sc = 0;
+    a.view().for_each([&sa](int x){ sa += x; });
+    c.view().for_each([&sc](int x){ sc += x; });
+    assert(sa==sc && sa==(0+10+20)*4+(0+1+2+3)*3);
+
+    // 分块转置
+    NDArray<int, 2> b(4, 3);
+    transpose(a.view(), b.view(), 2);
+    for (i=0; i!=3; i++)
+        for (j=0; j!=4; j++)
+            assert(b(j, i)==a(i, j));
+
+    // 分块访问
+    int tiles = 0;
+    for_each_tile(a.view(), 2, [&tiles](const NDView<int, 2> &tile){ tiles++; assert(tile.size()<=4); });
+    assert(tiles==4);
+
+    // 块的大小为0
+    int zero = 0;
+    try {
+        for_each_tile(a.view(), 0, [](const NDView<int, 2> &){});
+    } catch (const char *) {
+        zero++;
+    }
+    try {
+        transpose(a.view(), b.view(), 0);
+    } catch (const char *) {
+        zero++;
+    }
+    assert(zero==2);
+
+    // 拷贝复制元素
+    NDArray<int, 2> d(a);
+    d(0, 0) = 100;
+    assert(a(0, 0)==0);
+    d = c;
+    assert(d(2, 3)==23 && d.layout()==COL_MAJOR);
+
+    // 三维
+    NDArray<double, 3> e(2, 3, 4);
+    e(1, 2, 3) = 1.5;
+    assert(e.view().fix(0, 1)(2, 3)==1.5 && e.view().transposed()(3, 2, 1)==1.5);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
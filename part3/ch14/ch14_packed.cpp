@@ -0,0 +1,68 @@
+#include <iostream>
+#include <cassert>
+#include <climits>
+#include "packed_array.h"
+
+using namespace std;
+
+template<typename T>
+void check(const Array<T> &a)
+{
+    PackedArray<T> p(a);
+    assert(p.size()==a.size());
+    for (unsigned i=0; i!=a.size(); i++)
+        assert(p[i]==a[i]);
+    unsigned i = 0;
+    p.for_each([&](T v) { assert(v==a[i]); i++; });
+    assert(i==a.size());
+    Array<T> u = p.unpack();
+    for (i=0; i!=a.size(); i++)
+        assert(u[i]==a[i]);
+}
+
+int main()
+{
+    // 小的值：每个元素只需要4位
+    Array<int> small(1000);
+    for (unsigned i=0; i!=small.size(); i++)
+        small[i] = i*7 % 13;
+    check(small);
+    PackedArray<int> ps(small);
+    assert(ps.ratio() > 5);
+
+    // 有序的值：只保存与直线的偏差
+    Array<unsigned> sorted(5000);
+    for (unsigned i=0; i!=sorted.size(); i++)
+        sorted[i] = 1000000 + i*100 + i%3;
+    check(sorted);
+    assert(PackedArray<unsigned>(sorted).ratio() > 8);
+
+    // 常数块不占用任何位
+    Array<int> same(300);
+    for (unsigned i=0; i!=same.size(); i++)
+        same[i] = -5;
+    check(same);
+
+    // 负数与满位宽
+    Array<int> wide(257);
+    for (unsigned i=0; i!=wide.size(); i++)
+        wide[i] = i%2 ? INT_MAX - int(i) : INT_MIN + int(i);
+    check(wide);
+    Array<unsigned char> bytes(130);
+    for (unsigned i=0; i!=bytes.size(); i++)
+        bytes[i] = 255 - i;
+    check(bytes);
+
+    check(Array<int>());
+
+    bool thrown = false;
+    try {
+        ps[1000];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
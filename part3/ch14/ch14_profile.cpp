@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "profile.h"
+
+using namespace std;
+using profile::Histogram;
+
+int main()
+{
+    // 小于2*SUB的值精确记录
+    Histogram e;
+    assert(e.count()==0 && e.min()==0 && e.percentile(50)==0);
+    e.record(3);
+    e.record(7, 3);
+    assert(e.count()==4 && e.min()==3 && e.max()==7 && e.mean()==6);
+    assert(e.percentile(25)==3 && e.percentile(50)==7);
+
+    // 大值的相对误差不超过1/SUB
+    Histogram h;
+    for (unsigned long long v=1; v<=100000; v++)
+        h.record(v);
+    assert(h.count()==100000 && h.min()==1 && h.max()==100000);
+    assert(h.percentile(50)>=50000 && h.percentile(50)<=50000 + 50000/Histogram::SUB);
+    assert(h.percentile(100)==100000);
+
+    // 相邻的桶首尾相接
+    for (unsigned i=1; i!=Histogram::BUCKETS; i++)
+        assert(Histogram::bucket(Histogram::upper(i))==i
+               && Histogram::bucket(Histogram::upper(i-1)+1)==i);
+
+    // 最大的值落在最后一个桶中
+    assert(Histogram::bucket(1ull << 63)==Histogram::BUCKETS-1
+           && Histogram::bucket(~0ull)==Histogram::BUCKETS-1);
+    h.record(~0ull);
+    assert(h.max()==~0ull && h.percentile(100)==~0ull);
+
+    // 合并
+    e.merge(h);
+    assert(e.count()==100005 && e.min()==1 && e.max()==~0ull);
+    e.reset();
+    assert(e.count()==0 && e.max()==0);
+
+    // run：每次操作的延迟都记录下来；计数器不可用时输出null
+    unsigned long long sum = 0;
+    profile::Report r = profile::run("sum", 1000, [&](unsigned long long i) {sum += i;}, 10);
+    assert(sum==999*1000/2 && r.ops==1000 && r.latency.count()==1000);
+    string json = r.to_json();
+    assert(json.find("\"name\": \"sum\"")!=string::npos);
+    cout << json << endl;
+
+    cout << " --- OK." << endl;
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "rcu_array.h"
+
+using namespace std;
+
+int main()
+{
+    RcuArray<int> a;
+    for (int i=0; i!=10; i++)
+        a.push_back(i);
+    assert(a.size()==10);
+
+    {
+        // 快照在写者修改之后保持不变
+        RcuSnapshot<int> s = a.snapshot();
+        a.set(3, 30);
+        for (int i=10; i!=1000; i++)
+            a.push_back(i);
+        assert(s.size()==10 && s[3]==3 && s[9]==9);
+        RcuSnapshot<int> t = a.snapshot();
+        assert(t.size()==1000 && t[3]==30 && t[999]==999);
+
+        bool thrown = false;
+        try {
+            s[10];
+        } catch (const char *) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // 读者在写者不断增长数组时读取：每个快照都是完整的前缀
+    RcuArray<unsigned> b;
+    atomic<bool> stop(false);
+    vector<thread> readers;
+    atomic<unsigned long> checked(0);
+    for (unsigned r=0; r!=3; r++)
+        readers.push_back(thread([&]{
+            while (!stop) {
+                RcuSnapshot<unsigned> snap = b.snapshot();
+                for (unsigned i=0; i!=snap.size(); i++)
+                    assert(snap[i]==i);
+                checked += snap.size();
+            }
+        }));
+    for (unsigned i=0; i!=20000; i++)
+        b.push_back(i);
+    stop = true;
+    for (unsigned r=0; r!=readers.size(); r++)
+        readers[r].join();
+    assert(b.size()==20000);
+
+    // 所有读者(包括本线程的快照)都结束后，旧的缓冲区都可以释放
+    RcuDomain::instance().synchronize();
+    assert(RcuDomain::instance().pending()==0);
+    cout << checked.load() << " elements checked" << endl;
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
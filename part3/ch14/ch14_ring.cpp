@@ -0,0 +1,146 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ring_buffer.h"
+
+using namespace std;
+
+int main()
+{
+    // 容量取为2的幂
+    SpscRing<int> s(5);
+    assert(s.capacity()==8 && s.empty());
+    // 被测的操作都不放在assert中，定义了NDEBUG时仍然执行
+    bool ok;
+    for (int i=0; i!=8; i++) {
+        ok = s.push(i);
+        assert(ok);
+    }
+    ok = s.push(8);
+    assert(!ok && s.size()==8);
+    int v;
+    for (int i=0; i!=8; i++) {
+        ok = s.pop(v);
+        assert(ok && v==i);
+    }
+    ok = s.pop(v);
+    assert(!ok && s.empty());
+
+    bool thrown = false;
+    try {
+        SpscRing<int> bad(0);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 批量操作放入或取出尽可能多的元素，并且跨越回绕点
+    int in[6] = {10, 11, 12, 13, 14, 15}, out[8];
+    unsigned pushed = s.push(in, 6), popped = s.pop(out, 4);
+    assert(pushed==6 && popped==4 && out[3]==13);
+    pushed = s.push(in, 6);
+    assert(pushed==6 && s.size()==8);
+    popped = s.pop(out, 8);
+    assert(popped==8 && out[0]==14 && out[1]==15 && out[2]==10 && out[7]==15);
+    popped = s.pop(out, 8);
+    assert(popped==0);
+
+    // 一个生产者、一个消费者：元素按顺序到达
+    const unsigned n = 1000000;
+    SpscRing<unsigned> q(1024);
+    thread producer([&q, n]{
+        unsigned batch[32];
+        for (unsigned i=0; i<n; ) {
+            unsigned k = 0;
+            for (; k!=32 && i+k<n; k++)
+                batch[k] = i+k;
+            unsigned done = 0;
+            while (done!=k)
+                if (unsigned d = q.push(batch+done, k-done))
+                    done += d;
+                else
+                    this_thread::yield();       // 队列满，让出CPU给消费者
+            i += k;
+        }
+    });
+    unsigned expect = 0;
+    while (expect!=n) {
+        unsigned x;
+        if (q.pop(x)) {
+            assert(x==expect);
+            expect++;
+        } else
+            this_thread::yield();
+    }
+    producer.join();
+    assert(q.empty());
+
+    // MPMC：单线程下的语义与SPSC相同
+    MpmcRing<int> m(4);
+    pushed = m.push(in, 6);
+    ok = m.push(99);
+    assert(pushed==4 && !ok);
+    popped = m.pop(out, 3);
+    assert(popped==3 && out[0]==10 && out[2]==12);
+    pushed = m.push(in, 6);
+    assert(pushed==3 && m.size()==4);
+    popped = m.pop(out, 8);
+    assert(popped==4 && out[0]==13 && out[1]==10 && out[3]==12);
+    ok = m.pop(v);
+    assert(!ok && m.empty());
+
+    // 多个生产者、多个消费者：每个元素恰好被取出一次，同一生产者的元素保持顺序
+    const unsigned producers = 3, consumers = 3, per = 200000;
+    MpmcRing<unsigned> mq(256);
+    vector<vector<unsigned> > got(consumers);
+    atomic<unsigned> remaining(producers*per);
+    vector<thread> ts;
+    for (unsigned p=0; p!=producers; p++)
+        ts.push_back(thread([&mq, p, per]{
+            for (unsigned i=0; i!=per; ) {
+                unsigned b[8], k = 0;
+                for (; k!=8 && i+k!=per; k++)
+                    b[k] = p*per + i+k;
+                unsigned done = 0;
+                while (done!=k)
+                    if (unsigned d = mq.push(b+done, k-done))
+                        done += d;
+                    else
+                        this_thread::yield();
+                i += k;
+            }
+        }));
+    for (unsigned c=0; c!=consumers; c++)
+        ts.push_back(thread([&mq, &got, &remaining, c]{
+            unsigned b[8];
+            while (remaining.load()) {
+                unsigned k = mq.pop(b, 8);
+                if (k==0) {
+                    this_thread::yield();
+                    continue;
+                }
+                got[c].insert(got[c].end(), b, b+k);
+                remaining -= k;
+            }
+        }));
+    for (unsigned t=0; t!=ts.size(); t++)
+        ts[t].join();
+    vector<bool> seen(producers*per);
+    for (unsigned c=0; c!=consumers; c++) {
+        vector<unsigned> last(producers, 0);
+        for (unsigned i=0; i!=got[c].size(); i++) {
+            unsigned x = got[c][i];
+            assert(!seen[x]);
+            seen[x] = true;
+            assert(x%per==0 || x>last[x/per]);
+            last[x/per] = x;
+        }
+    }
+    for (unsigned i=0; i!=seen.size(); i++)
+        assert(seen[i]);
+
+    cout << " --- OK." << endl;
+    return 0;
+}
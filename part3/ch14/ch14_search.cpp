@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include "search_index.h"
+
+using namespace std;
+
+// 与std::lower_bound比较所有可能的查找结果
+static void check(const Array<int> &a)
+{
+    EytzingerIndex<int> idx(a);
+    assert(idx.size()==a.size());
+    vector<int> v;
+    for (unsigned i=0; i!=a.size(); i++)
+        v.push_back(a[i]);
+    vector<int> xs;
+    int lo = v.empty() ? 0 : v.front(), hi = v.empty() ? 0 : v.back();
+    for (int x=lo-2; x<=hi+2; x++)
+        xs.push_back(x);
+    vector<unsigned> batch(xs.size());
+    idx.lower_bound(&xs[0], xs.size(), &batch[0]);
+    unique_ptr<bool[]> found(new bool[xs.size()]);
+    unsigned hits = idx.contains(&xs[0], xs.size(), found.get());
+    unsigned expect_hits = 0;
+    for (unsigned i=0; i!=xs.size(); i++) {
+        unsigned lb = lower_bound(v.begin(), v.end(), xs[i]) - v.begin();
+        bool in = binary_search(v.begin(), v.end(), xs[i]);
+        assert(idx.lower_bound(xs[i])==lb && batch[i]==lb);
+        assert(idx.contains(xs[i])==in && found[i]==in);
+        expect_hits += in;
+    }
+    assert(hits==expect_hits);
+}
+
+int main()
+{
+    // 各种大小：空、满二叉树、最后一层不满
+    for (unsigned n=0; n!=70; n++) {
+        Array<int> a(n);
+        for (unsigned i=0; i!=n; i++)
+            a[i] = 3*i;
+        check(a);
+    }
+
+    // 有重复的键时返回第一个
+    mt19937 gen(11);
+    for (unsigned round=0; round!=20; round++) {
+        unsigned n = gen()%2000;
+        vector<int> v(n);
+        for (unsigned i=0; i!=n; i++)
+            v[i] = gen()%(n/4+1);
+        sort(v.begin(), v.end());
+        Array<int> a(n);
+        for (unsigned i=0; i!=n; i++)
+            a[i] = v[i];
+        check(a);
+    }
+
+    // 浮点数与64位整数的键
+    Array<double> d(1000);
+    for (unsigned i=0; i!=1000; i++)
+        d[i] = i*0.5;
+    EytzingerIndex<double> di(d);
+    assert(di.lower_bound(10.25)==21 && di.contains(10.5) && !di.contains(10.25));
+    Array<long long> l(100000);
+    for (unsigned i=0; i!=100000; i++)
+        l[i] = (long long)i << 32;
+    EytzingerIndex<long long> li(l);
+    assert(li.lower_bound(5ll<<32)==5 && li.lower_bound((5ll<<32)+1)==6 && li.lower_bound(1ll<<62)==100000);
+
+    // 未排序的数组
+    Array<int> u(3);
+    u[0] = 1; u[1] = 0; u[2] = 2;
+    bool thrown = false;
+    try {
+        EytzingerIndex<int> bad(u);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    cout << " --- OK." << endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include <string>
+#include "segmented_array.h"
+
+using namespace std;
+
+// 值为负时复制抛出异常
+struct Fragile{
+    int v;
+    explicit Fragile(int v):v(v) {}
+    Fragile(const Fragile &f):v(f.v) {
+        if (v<0)
+            throw "Fragile copy.";
+    }
+};
+
+int main()
+{
+    SegmentedArray<int> a;
+    assert(a.size()==0 && a.get(0)==0);
+
+    // 元素的地址在增长后不变
+    unsigned i = a.push_back(7);
+    assert(i==0);
+    const int *p0 = &a[0];
+    for (i=1; i!=10000; i++) {
+        unsigned at = a.push_back(i);
+        assert(at==i);
+    }
+    assert(a.size()==10000 && p0==&a[0] && *p0==7 && a[9999]==9999);
+
+    // 越界访问
+    bool thrown = false;
+    try {
+        a[10000];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 多个线程同时追加，每个值恰好出现一次
+    SegmentedArray<unsigned> b;
+    const unsigned threads = 4, per = 50000;
+    vector<thread> ts;
+    for (unsigned t=0; t!=threads; t++)
+        ts.push_back(thread([&b, t]{
+            for (unsigned k=0; k!=per; k++)
+                b.push_back(t*per + k);
+        }));
+    // 写者运行时读者也可以读取已经发布的元素
+    unsigned seen = 0;
+    for (i=0; i!=b.size(); i++)
+        if (b.get(i)) seen++;
+    for (unsigned t=0; t!=threads; t++)
+        ts[t].join();
+    assert(b.size()==threads*per && seen<=threads*per);
+    vector<bool> found(threads*per, false);
+    for (i=0; i!=b.size(); i++) {
+        assert(!found[b[i]]);
+        found[b[i]] = true;
+    }
+
+    // 非平凡的元素类型
+    SegmentedArray<string> c;
+    c.push_back("hello");
+    c.push_back(string(100, 'x'));
+    assert(c[0]=="hello" && c[1].size()==100);
+
+    // 复制抛出异常时占用的下标不会发布，之后的元素不受影响
+    SegmentedArray<Fragile> d;
+    d.push_back(Fragile(1));
+    thrown = false;
+    try {
+        d.push_back(Fragile(-1));
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown && d.size()==2 && d.get(1)==0);
+    i = d.push_back(Fragile(3));
+    assert(i==2 && d[0].v==1 && d[2].v==3);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cassert>
+#include "small_array.h"
+
+using namespace std;
+
+// 统计存活的对象个数
+struct Counted{
+    static int live;
+    Counted() {live++;}
+    ~Counted() {live--;}
+};
+int Counted::live = 0;
+
+int main()
+{
+    SmallArray<int, 4> a;
+    assert(a.size()==0 && a.is_inline());
+
+    // 不超过4个元素时保存在对象内部
+    a.resize(3);
+    a[0] = 1;
+    a[2] = 3;
+    assert(a.is_inline() && a[0]==1 && a[1]==0 && a[2]==3);
+
+    // 越界访问
+    bool thrown = false;
+    try {
+        a[3];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 缩小后再增长，新元素是缺省值
+    a.resize(1);
+    a.resize(3);
+    assert(a[0]==1 && a[2]==0);
+
+    // 增长到超过4个元素时溢出到ArrayData
+    a[2] = 3;
+    a.reserve(4);
+    assert(!a.is_inline() && a.size()==6 && a[0]==1 && a[2]==3 && a[5]==0);
+
+    // 拷贝与赋值
+    SmallArray<int, 4> b(a);
+    assert(b.size()==6 && b[2]==3);
+    b[2] = 30;
+    assert(a[2]==3);
+    SmallArray<int, 4> c(2);
+    c[1] = 7;
+    b = c;
+    assert(b.size()==2 && b[1]==7);
+    c = a;
+    assert(!c.is_inline() && c.size()==6 && c[2]==3);
+
+    // 作为Array的元素
+    Array<SmallArray<int, 8> > rows(100);
+    for (unsigned i=0; i!=100; i++) {
+        rows[i].resize(4);
+        rows[i][3] = i;
+    }
+    rows.resize(200);
+    assert(rows[99][3]==99 && rows[99].is_inline() && rows[150].size()==0);
+
+    // 溢出后再增长，新元素同样是缺省值
+    SmallArray<int, 2> d(2);
+    d[0] = d[1] = 9;
+    d.resize(3);
+    d.resize(5);
+    assert(!d.is_inline() && d[1]==9 && d[2]==0 && d[4]==0);
+
+    // 内部空间只构造前size()个元素
+    {
+        SmallArray<Counted, 8> f;
+        assert(Counted::live==0);
+        f.resize(3);
+        assert(Counted::live==3);
+        f.resize(1);
+        assert(Counted::live==1);
+        f.resize(20);
+        assert(!f.is_inline() && f.size()==20);
+    }
+    assert(Counted::live==0);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
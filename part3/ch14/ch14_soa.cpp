@@ -0,0 +1,129 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include "soa.h"
+
+using namespace std;
+
+struct Particle{
+    float x, y;
+    float vx, vy;
+    int id;
+};
+
+typedef SoaArray<Particle,
+                 SOA_FIELD(Particle, x), SOA_FIELD(Particle, y),
+                 SOA_FIELD(Particle, vx), SOA_FIELD(Particle, vy),
+                 SOA_FIELD(Particle, id)> Particles;
+
+// 构造第LIMIT个对象时抛出异常，用来检查SoaColumn::resize的异常安全性
+struct Fragile{
+    static int live, limit;
+    Fragile() {
+        if (live==limit) throw "too many Fragile objects.";
+        live++;
+    }
+    Fragile(const Fragile &) {
+        if (live==limit) throw "too many Fragile objects.";
+        live++;
+    }
+    ~Fragile() {live--;}
+};
+int Fragile::live = 0, Fragile::limit = 1000;
+
+struct Holder{
+    int id;
+    Fragile f;
+};
+
+int main()
+{
+    Particles ps(10);
+    assert(ps.size()==10);
+
+    // 整条记录的读写
+    unsigned i;
+    for (i=0; i!=10; i++) {
+        Particle p = {float(i), float(2*i), 1.0f, -1.0f, int(i)};
+        ps[i] = p;
+    }
+    Particle p5 = ps[5];
+    assert(p5.x==5 && p5.y==10 && p5.vx==1 && p5.id==5);
+
+    // 单个字段
+    ps[3].get<4>() = 33;
+    assert(ps[3].get<4>()==33 && ps.column<4>()[3]==33);
+
+    // 每一列连续存放并按缓存行对齐
+    assert(reinterpret_cast<uintptr_t>(ps.column<0>()) % 64 == 0);
+    assert(reinterpret_cast<uintptr_t>(ps.column<3>()) % 64 == 0);
+    float *x = ps.column<0>();
+    const float *vx = ps.column<2>();
+    for (i=0; i!=ps.size(); i++)
+        x[i] += vx[i];
+    assert(ps[9].get<0>()==10);
+
+    // 越界访问
+    bool thrown = false;
+    try {
+        ps[10];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // SoaPointer在resize后仍然有效
+    SoaPointer<Particle,
+               SOA_FIELD(Particle, x), SOA_FIELD(Particle, y),
+               SOA_FIELD(Particle, vx), SOA_FIELD(Particle, vy),
+               SOA_FIELD(Particle, id)> p(ps, 2), end(ps, 10);
+    ps.reserve(20);
+    assert(ps.size()==40 && (*p).get<4>()==2 && ps[9].get<4>()==9);
+    int n = 0;
+    for (; p!=end; ++p)
+        n++;
+    assert(n==8);
+
+    // 拷贝复制各列
+    const Particles copy(ps);
+    ps[0].get<1>() = -5;
+    assert(copy[0].y==0 && copy.size()==40);
+
+    // 元素之间的赋值复制所有字段
+    ps[1] = ps[7];
+    Particle p1 = ps[1];
+    assert(p1.x==8 && p1.y==14 && p1.id==7 && ps[7].get<4>()==7);
+    ps[2] = ps[2];
+    assert(ps[2].get<4>()==2);
+
+    // resize中构造元素失败时，原来的列不变，也不泄漏新的缓冲区
+    SoaColumn<Fragile> col;
+    col.resize(3);
+    assert(Fragile::live==3);
+    Fragile::limit = 5;
+    thrown = false;
+    try {
+        col.resize(10);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown && Fragile::live==3);
+
+    // SoaArray::resize中某一列抛出异常时，所有的列都保持原来的长度
+    SoaArray<Holder, SOA_FIELD(Holder, id), SOA_FIELD(Holder, f)> h(2);
+    Fragile::limit = Fragile::live + 2;
+    int *ids = h.column<0>();
+    thrown = false;
+    try {
+        h.resize(10);
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown && h.size()==2 && h.column<0>()==ids && Fragile::live==5);
+    Fragile::limit = 1000;
+    h.resize(4);
+    assert(h.size()==4 && h.column<0>()[3]==0 && Fragile::live==7);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include "array_sort.h"
+
+using namespace std;
+
+struct Record {
+    int key;
+    unsigned seq;   // 原来的位置，用来检查稳定性
+};
+
+template<typename T, typename C>
+bool is_sorted(const Array<T> &a, C less)
+{
+    for (unsigned i=1; i<a.size(); i++)
+        if (less(a[i], a[i-1]))
+            return false;
+    return true;
+}
+
+int main()
+{
+    mt19937 gen(5);
+    const unsigned n = 300000;      // 足够分给4个线程
+
+    Array<int> a(n);
+    for (unsigned i=0; i!=n; i++)
+        a[i] = int(gen());
+    radix_sort(a, 4);
+    assert(is_sorted(a, [](int x, int y) { return x<y; }));
+
+    Array<double> d(n);
+    for (unsigned i=0; i!=n; i++)
+        d[i] = (double(gen()) - 2e9) / 3.0;
+    d[7] = -0.0;
+    d[8] = 0.0;
+    radix_sort(d, 4);
+    assert(is_sorted(d, [](double x, double y) { return x<y; }));
+
+    // 按键排序记录，相同的键保持原来的顺序
+    Array<Record> r(n), m(n);
+    for (unsigned i=0; i!=n; i++) {
+        Record x = {int(gen()%1000) - 500, i};
+        r[i] = m[i] = x;
+    }
+    radix_sort_by(r, [](const Record &x) { return x.key; }, 4);
+    auto stable = [](const Record &x, const Record &y) {
+        return x.key<y.key || (x.key==y.key && x.seq<y.seq);
+    };
+    assert(is_sorted(r, stable));
+    merge_sort(m, [](const Record &x, const Record &y) { return x.key<y.key; }, 3);
+    assert(is_sorted(m, stable));
+
+    // 任意比较函数与不能直接复制内存的类型
+    Array<string> s(5000);
+    for (unsigned i=0; i!=s.size(); i++)
+        s[i] = to_string(gen()%100000);
+    merge_sort(s);
+    assert(is_sorted(s, [](const string &x, const string &y) { return x<y; }));
+
+    // 辅助缓冲区在多次排序之间重用
+    SortScratch<unsigned> scratch;
+    Array<unsigned> u(1000);
+    for (unsigned k=0; k!=3; k++) {
+        for (unsigned i=0; i!=u.size(); i++)
+            u[i] = gen();
+        radix_sort(u, 1, scratch);
+        assert(is_sorted(u, [](unsigned x, unsigned y) { return x<y; }));
+    }
+    assert(scratch.capacity()==1000);
+
+    Array<int> empty;
+    radix_sort(empty);
+    merge_sort(empty);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "sparse_array.h"
+
+using namespace std;
+
+int main()
+{
+    // 与ch13_v4相同的用法，只分配了一页
+    SparseArray<int> a(10);
+    a.resize(100);
+    a.reserve(200);
+    a[200] = 1;
+    assert(a.size()==400 && a.pages()==1);
+    assert(a.bytes() < a.size()*sizeof(int));
+
+    // 只读访问不分配页
+    const SparseArray<int> &ca = a;
+    SparseArray<int> big(1000000);
+    const SparseArray<int> &cbig = big;
+    assert(cbig[999999]==0 && big.pages()==0);
+    big[10] = 5;
+    big[500000] = 7;
+    big[999999] = 9;
+    assert(big.pages()==3 && cbig[500000]==7 && cbig[500001]==0);
+
+    // 只访问非默认值的元素
+    unsigned count = 0, last = 0;
+    big.for_each([&](unsigned i, int v) { count++; last = i; assert(v!=0); });
+    assert(count==3 && last==999999);
+
+    // 指针：与Pointer一样保存下标，并共享实现类
+    SparsePointer<int> p(big, 500000);
+    SparsePtr_to_const<int> cp(ca, 200);
+    assert(*p==7 && *cp==1);
+    *++p = 8;
+    assert(big[500001]==8 && p-SparsePointer<int>(big)==500001);
+    {
+        SparseArray<int> tmp(10);
+        tmp[3] = 3;
+        p = SparsePointer<int>(tmp, 3);
+    }
+    assert(*p==3);      // tmp已经销毁，实现类仍然存在
+
+    // 复制是深复制
+    SparseArray<int> copy(big);
+    copy[10] = 6;
+    assert(big[10]==5 && copy[10]==6 && copy.pages()==big.pages());
+
+    // 缩小后再增长，被截掉的元素恢复为默认值
+    big.resize(500001);
+    assert(big.pages()==2);
+    big.resize(1000000);
+    assert(cbig[500001]==0 && cbig[999999]==0 && big[500000]==7);
+
+    bool thrown = false;
+    try {
+        cbig[1000000];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    SparseArray<string> s(1 << 20);
+    s[12345] = "x";
+    assert(s[12345]=="x" && s.pages()==1);
+
+    std::cout << " --- OK." << std::endl;
+    return 0;
+}
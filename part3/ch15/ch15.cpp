@@ -1,76 +1,22 @@
 #include <iostream>
 #include <cassert>
+#include <thread>
+#include <vector>
+#include "seq.h"
 
-template<typename T>
-class Seq ;
-template<typename T>
-class SeqItem {
-    friend class Seq<T>;
-    SeqItem(const T&d, SeqItem *n):use(1), data(d), next(n){
-        if (next)  ++next->use; 
-    };
-
-    int use;
-    SeqItem<T> *next;
-    T data;
-};
-
-template<typename T>
-class Seq {
-public:
-    Seq():item(0){};
-    Seq(T &v, const Seq& s):item(new SeqItem<T>(v,s.item)){};
-    Seq(const Seq& s):item(s.item){if (item) ++item->use;};
-
-    Seq& operator=(const Seq& s) {// s 并没有被改写，只是s.item->use被改写了, 所以可以用const修饰！！！
-        if (s.item) ++s.item->use; 
-        destroy(item);
-        item = s.item;
-        return *this;
-    }
-    ~Seq() {
-        destroy(item);
-    };
-
-    T hd() const {
-        if (item) return item->data;
-        else throw "hd of an empty Seq";
-    };
-
-    Seq tl() const{
-        if (item) return Seq(item->next);
-        else throw "tl of an empty Seq";
-    };
-
-    operator bool() { return item!=0; };
-
-    Seq& operator++() {
-        if (item) {
-            SeqItem<T> *temp = item;
-            item = item->next;
-            if (--item->use==0) delete temp;
-        }
-        return *this;    
-    }
-    
-    T operator*()const{
-        return hd(); 
-    }
-
-private:
-    void destroy(SeqItem<T> *i) {
-        SeqItem<T> *next = i;
-        while (i&&--i->use==0) {
-            next = i->next;
-            delete i;
-            i = next; 
-        }
-    }
-    Seq(SeqItem<T> *si):item(si){if (item) ++item->use;};
-
-    SeqItem<T> *item;
+// 没有std::hash与operator==的类型也可以放进Seq，只是不能驻留
+struct Point {
+    int x, y;
 };
 
+// 在驻留模式下构建[0, n)，头部是n-1
+static Seq<int> build(int n)
+{
+    Seq<int> s;
+    for (int i=0; i!=n; i++)
+        s = Seq<int>(i, s);
+    return s;
+}
 
 int main()
 {
@@ -107,6 +53,72 @@ int main()
         i--;
     }
 
+    // ++ 与 tl() 等价
+    Seq<int> si3 = build(3);
+    ++si3;
+    assert(si3.hd()==1 && si3==build(2));
+
+    // 驻留模式：独立构建的相同Seq共享同一组节点
+    Seq<int>::interning(true);
+    Seq<int> a = build(1000);
+    Seq<int> b = build(1000);
+    assert(a==b && a.tl()==b.tl() && a!=b.tl());
+    SeqInternStats st = Seq<int>::intern_stats();
+    assert(st.lookups==2000 && st.hits==1000 && st.nodes==1000);
+
+    // 多个线程同时构建
+    std::vector<std::thread> threads;
+    std::vector<Seq<int> > results(4);
+    for (i=0; i!=4; i++)
+        threads.push_back(std::thread([&results, i]{ results[i] = build(1000); }));
+    for (i=0; i!=4; i++)
+        threads[i].join();
+    for (i=0; i!=4; i++)
+        assert(results[i]==a);
+    assert(Seq<int>::intern_stats().nodes==1000);
+
+    // 非驻留的Seq逐个元素比较
+    Seq<int>::interning(false);
+    Seq<int> c = build(1000);
+    assert(c==a && c!=a.tl());
+    st = Seq<int>::intern_stats();
+    std::cout << "interning: " << st.hits << "/" << st.lookups << " hits ("
+              << st.hit_rate()*100 << "%), " << st.bytes_saved << " bytes saved" << std::endl;
+
+    a = Seq<int>();
+    b = a;
+    results.clear();
+    assert(Seq<int>::intern_stats().nodes==0);
+
+    // 计数器(编译时定义了RUMINATIONS_INSTRUMENT才计数)
+    instrument::Snapshot before = instrument::snapshot();
+    Seq<int> s10 = build(10);
+    Seq<int> s10copy = s10;
+    instrument::Snapshot st1 = instrument::snapshot() - before;
+    if (instrument::enabled)
+        assert(st1[instrument::SEQITEM_ALLOC]==10 && st1[instrument::REFCOUNT_INC]>=1);
+    std::cout << st1.to_json() << std::endl;
+
+    // 增量回收
+    Seq<int>::reclaim_slice(64);
+    Seq<int> *longseq = new Seq<int>(build(10000));
+    Seq<int> shared = longseq->tl().tl();
+    delete longseq;         // 只释放了前面的2个节点
+    assert(!Seq<int>::reclaim_pending() && shared.hd()==9997);
+    shared = Seq<int>();    // 释放64个，其余挂起
+    assert(Seq<int>::reclaim_pending());
+    assert(Seq<int>::reclaim(100)==100);
+    Seq<int>::reclaim_all();
+    assert(!Seq<int>::reclaim_pending());
+    Seq<int>::reclaim_slice(0);
+
+    Seq<Point> ps;
+    for (int k=0; k!=5; k++) {
+        Point p = {k, -k};
+        ps = Seq<Point>(p, ps);
+    }
+    assert(ps.hd().x==4 && ps.tl().hd().y==-3);
+
     std::cout << " ---OK---."  << std::endl;   
 
     return 0;
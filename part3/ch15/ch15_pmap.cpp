@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <random>
+#include <string>
+#include "pmap.h"
+
+using namespace std;
+
+// 检查顺序、大小与平衡条件
+template<typename K, typename V>
+void check(const PMap<K, V> &m, const map<K, V> &ref)
+{
+    assert(m.size()==ref.size());
+    typename map<K, V>::const_iterator it = ref.begin();
+    m.for_each([&](const K &k, const V &v) {
+        assert(it!=ref.end() && it->first==k && it->second==v);
+        ++it;
+    });
+    assert(it==ref.end());
+    for (PMapCursor<K, V> c(m); c; ++c)
+        assert(ref.at(c.key())==c.value());
+}
+
+int main()
+{
+    // 路由表的几个版本共享大部分节点
+    PMap<string, int> v0;
+    PMap<string, int> v1 = v0.insert("10.0.0.0/8", 1).insert("192.168.0.0/16", 2);
+    PMap<string, int> v2 = v1.insert("172.16.0.0/12", 3);
+    PMap<string, int> v3 = v2.erase("10.0.0.0/8").insert("192.168.0.0/16", 4);
+    assert(v0.empty() && v1.size()==2 && v2.size()==3 && v3.size()==2);
+    assert(v1["192.168.0.0/16"]==2 && v3["192.168.0.0/16"]==4);
+    assert(v2.contains("10.0.0.0/8") && !v3.contains("10.0.0.0/8"));
+    assert(v3.erase("no such route").same(v3));
+
+    bool thrown = false;
+    try {
+        v3.at("10.0.0.0/8");
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 随机的插入和删除，与std::map比较；每个旧版本都保持不变
+    mt19937 gen(11);
+    PMap<int, int> m;
+    map<int, int> ref;
+    vector<PMap<int, int> > versions;
+    vector<map<int, int> > refs;
+    for (unsigned i=0; i!=20000; i++) {
+        int k = gen()%5000;
+        if (gen()%3) {
+            m = m.insert(k, i);
+            ref[k] = i;
+        } else {
+            m = m.erase(k);
+            ref.erase(k);
+        }
+        if (i%2000==0) {
+            versions.push_back(m);
+            refs.push_back(ref);
+        }
+    }
+    check(m, ref);
+    for (unsigned i=0; i!=versions.size(); i++)
+        check(versions[i], refs[i]);
+
+    // 遍历快照时继续修改
+    PMapCursor<int, int> c(m);
+    unsigned n = 0;
+    for (; c; ++c, n++)
+        m = m.erase(c.key());
+    assert(m.empty() && n==ref.size());
+
+    // 有序插入：不保持平衡的话树会退化成链表，这里就是O(n^2)的
+    PMap<int, int> seq;
+    for (int i=0; i!=100000; i++)
+        seq = seq.insert(i, i);
+    assert(seq.size()==100000 && seq[99999]==99999);
+
+    std::cout << " ---OK---." << std::endl;
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <cassert>
+#include "pvector.h"
+
+int main()
+{
+    // 空向量
+    PVector<int> v0;
+    assert(v0.size()==0);
+
+    // push_back返回新版本，旧版本保持不变
+    PVector<int> v = v0;
+    int i;
+    for (i=0; i!=5000; i++)
+        v = v.push_back(i);
+    assert(v.size()==5000 && v0.size()==0);
+    for (i=0; i!=5000; i++)
+        assert(v[i]==i);
+
+    PVector<int> v1 = v.set(1234, -1);
+    assert(v1[1234]==-1 && v[1234]==1234);
+    PVector<int> v2 = v1.set(4999, -2).push_back(5000);
+    assert(v2[4999]==-2 && v1[4999]==4999 && v2[5000]==5000 && v1.size()==5000);
+
+    // 越界访问
+    bool thrown = false;
+    try {
+        v0[0];
+    } catch (const char *) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 批量构建
+    TransientPVector<int> t = v.transient();
+    for (i=0; i!=40000; i++)
+        t.push_back(5000+i);
+    t.set(0, 100);
+    PVector<int> big = t.persistent();
+    t.set(1, 101);
+    assert(big.size()==45000 && big[0]==100 && big[1]==1 && big[44999]==44999);
+    assert(v[0]==0 && v.size()==5000);
+    assert(t[1]==101);
+
+    std::cout << " ---OK---." << std::endl;
+    return 0;
+}